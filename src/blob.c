@@ -17,69 +17,276 @@
 */
 
 #include "blob.h"
-#include "ieee754.h"
+#include "blob_private.h"
 
-#define pack754_32(f) (pack754((f), 32, 8))
-#define pack754_64(f) (pack754((f), 64, 11))
-#define unpack754_32(i) (unpack754((i), 32, 8))
-#define unpack754_64(i) (unpack754((i), 64, 11))
+// offsets are counted as if the root element always had a short header so that they stay valid when the root is extended
+static inline char *blob_offset_base(struct blob *buf){
+	struct blob_field *head = blob_head(buf); 
+	return (char*)head + blob_field_header_len(head) - sizeof(struct blob_field); 
+}
 
 static inline struct blob_field *blob_offset_to_attr(struct blob *buf, blob_offset_t offset){
-	void *ptr = (char *)buf->buf + (size_t)offset;
+	void *ptr = blob_offset_base(buf) + (size_t)offset;
 	return ptr;
 }
 
 static inline blob_offset_t blob_field_to_offset(struct blob *buf, struct blob_field *attr){
-	return (blob_offset_t)((char *)attr - (char *) buf->buf);
+	return (blob_offset_t)((char *)attr - blob_offset_base(buf));
+}
+
+static inline size_t blob_max_size(struct blob *buf){
+	return (buf->max_size)?buf->max_size:BLOB_MAX_SIZE; 
+}
+
+//! moves the content of a field 8 bytes up and switches it to the extended header. Memory for the extra bytes must already be there. 
+static void blob_field_extend(struct blob_field *attr, size_t len){
+	memmove((char*)attr + BLOB_FIELD_EXTENDED_HDR_LEN, attr->data, len - sizeof(struct blob_field)); 
+	attr->id_len |= htobe32(BLOB_FIELD_EXTENDED); 
+	attr->id_len &= ~htobe32(BLOB_FIELD_LEN_MASK); 
+	blob_field_set_raw_len(attr, len + sizeof(uint64_t)); 
+}
+
+static void *blob_libc_alloc(void *ctx, size_t size){
+	return malloc(size); 
+}
+
+static void *blob_libc_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size){
+	return realloc(ptr, new_size); 
+}
+
+static void blob_libc_free(void *ctx, void *ptr, size_t size){
+	free(ptr); 
+}
+
+const struct blob_allocator blob_default_allocator = {
+	.alloc = blob_libc_alloc, 
+	.realloc = blob_libc_realloc, 
+	.free = blob_libc_free, 
+	.ctx = NULL
+}; 
+
+static void *blob_fixed_alloc(void *ctx, size_t size){
+	return NULL; 
+}
+
+static void *blob_fixed_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size){
+	return NULL; 
+}
+
+static void blob_fixed_free(void *ctx, void *ptr, size_t size){
+	// memory belongs to the caller
 }
 
-static void blob_field_init(struct blob_field *attr, uint32_t id, uint32_t len){
-	assert(attr); 
-	memset(attr, 0, sizeof(struct blob_field)); 
-	//len += sizeof(struct blob_field); 
-	len &= BLOB_FIELD_LEN_MASK;
-	len |= (id << BLOB_FIELD_ID_SHIFT) & BLOB_FIELD_ID_MASK;
-	attr->id_len = htobe32(len);
+// allocator for blobs built in caller provided memory. It never hands out memory so resizing always fails. 
+static const struct blob_allocator blob_fixed_allocator = {
+	.alloc = blob_fixed_alloc, 
+	.realloc = blob_fixed_realloc, 
+	.free = blob_fixed_free, 
+	.ctx = NULL
+}; 
+
+// allocator used by blob_init when no allocator is given
+static const struct blob_allocator *blob_init_allocator = &blob_default_allocator; 
+
+void blob_set_default_allocator(const struct blob_allocator *alloc){
+	blob_init_allocator = (alloc)?alloc:&blob_default_allocator; 
+}
+
+const struct blob_allocator *blob_get_default_allocator(void){
+	return blob_init_allocator; 
+}
+
+// new memory is not cleared: every field that is written zeroes its own padding so the unused tail never reaches the output
+static bool blob_realloc(struct blob *buf, size_t newsize){
+	char *new = buf->alloc->realloc(buf->alloc->ctx, buf->buf, buf->memlen, newsize);
+	if(!new) return false; 
+	buf->buf = new;
+	buf->memlen = newsize;  
+	return true; 
+}
+
+static size_t blob_grow_size(struct blob *buf, size_t minlen){
+	size_t step = (buf->grow_step)?buf->grow_step:BLOB_GROW_STEP; 
+	size_t newsize = ((minlen / step) + 1) * step;
+	// doubling the area makes the total amount of copying linear in the final size
+	if(buf->growth == BLOB_GROWTH_GEOMETRIC && newsize < buf->memlen * 2)
+		newsize = buf->memlen * 2; 
+	// never ask for more than the blob may use unless minlen itself needs it
+	size_t max = blob_max_size(buf); 
+	if(newsize > max) newsize = (minlen > max)?minlen:max; 
+	return newsize; 
 }
 
 //! Attepts to reallocate the buffer to fit the new payload data
-bool blob_resize(struct blob *buf, uint32_t minlen){
-	assert(minlen > 0 && minlen < BLOB_MAX_SIZE); 
+bool blob_resize(struct blob *buf, size_t minlen){
+	assert(minlen > 0); 
+	if(buf->flags & (BLOB_FLAG_READONLY | BLOB_FLAG_MEASURE)) return false; 
+
+	// the root element needs an extended header once the buffer grows over what fits into a short one
+	bool extend = minlen > BLOB_FIELD_LEN_MASK && !blob_field_is_extended(blob_head(buf)); 
+	if(extend) minlen += sizeof(uint64_t); 
+
+	if(minlen > blob_max_size(buf)) return false; 
 
-	char *new = 0;
-	uint32_t newsize = ((minlen / 256) + 1) * 256;
-	uint32_t cur_size = blob_size(buf); 
 	// reallocate the memory of the buffer if we no longer have any memory left
-	if(newsize > buf->memlen){
-		new = realloc(buf->buf, newsize);
-		if (new) {
-			buf->buf = new;
-			memset((char*)buf->buf + cur_size, 0, newsize - cur_size);
-			buf->memlen = newsize;  
-		} else { 
-			return false; 
-		}
+	if(minlen > buf->memlen){
+		if(!blob_realloc(buf, blob_grow_size(buf, minlen))) return false; 
 	} 
+	if(extend) blob_field_extend(blob_head(buf), blob_field_raw_len(blob_head(buf))); 
 	blob_field_set_raw_len(blob_head(buf), minlen);  
 	blob_field_fill_pad(blob_head(buf)); 
 	return true;
 }
 
+bool blob_reserve(struct blob *buf, size_t size){
+	assert(buf); 
+	// keep the memory area aligned to field boundary
+	size = (size + BLOB_FIELD_ALIGN - 1) & ~(BLOB_FIELD_ALIGN - 1); 
+	if(buf->flags & BLOB_FLAG_READONLY) return false; 
+	if(size > blob_max_size(buf)) return false; 
+	if(buf->flags & BLOB_FLAG_MEASURE) return true; 
+	if(size <= buf->memlen) return true; 
+	return blob_realloc(buf, size); 
+}
+
+void blob_set_max_size(struct blob *buf, size_t size){
+	assert(buf); 
+	buf->max_size = size; 
+}
+
+void blob_set_inline(struct blob *buf, bool enable){
+	assert(buf); 
+	if(enable) buf->flags |= BLOB_FLAG_INLINE; 
+	else buf->flags &= (uint8_t)~BLOB_FLAG_INLINE; 
+}
+
+void blob_set_growth(struct blob *buf, enum blob_growth policy, uint32_t step){
+	assert(buf); 
+	buf->growth = policy; 
+	buf->grow_step = step; 
+}
+
+// a key in the dictionary of a blob
+struct blob_key {
+	uint32_t hash; 
+	uint32_t len; // length of the key without terminator
+	size_t name; // position of the key in the name pool
+	size_t offset; // offset of the string field that holds the key (0 for an empty slot)
+}; 
+
+struct blob_keys {
+	struct blob_key *slots; // open addressing hash table
+	size_t size; // number of slots (power of two)
+	size_t count; // used slots
+	char *names; // copies of all keys (fields can not be read back in measure mode)
+	size_t names_len; 
+	size_t names_cap; 
+}; 
+
+#define BLOB_KEYS_MIN_SLOTS (32)
+
+static void blob_keys_clear(struct blob_keys *keys){
+	if(!keys) return; 
+	memset(keys->slots, 0, keys->size * sizeof(struct blob_key)); 
+	keys->count = 0; 
+	keys->names_len = 0; 
+}
+
+//! returns the slot that holds key or the empty slot where it goes
+static struct blob_key *blob_keys_find(struct blob_keys *keys, const char *key, size_t len, uint32_t hash){
+	size_t mask = keys->size - 1; 
+	for(size_t idx = hash & mask;; idx = (idx + 1) & mask){
+		struct blob_key *slot = &keys->slots[idx]; 
+		if(!slot->offset) return slot; 
+		if(slot->hash == hash && slot->len == len && memcmp(keys->names + slot->name, key, len) == 0) return slot; 
+	}
+}
+
+static bool blob_keys_grow(struct blob_keys *keys){
+	struct blob_key *old = keys->slots; 
+	size_t old_size = keys->size; 
+	struct blob_key *slots = calloc(old_size * 2, sizeof(struct blob_key)); 
+	if(!slots) return false; 
+	keys->slots = slots; 
+	keys->size = old_size * 2; 
+	for(size_t c = 0; c < old_size; c++){
+		if(!old[c].offset) continue; 
+		*blob_keys_find(keys, keys->names + old[c].name, old[c].len, old[c].hash) = old[c]; 
+	}
+	free(old); 
+	return true; 
+}
+
+//! remembers that the key was written to a string field at offset
+static void blob_keys_add(struct blob_keys *keys, struct blob_key *slot, const char *key, size_t len, uint32_t hash, size_t offset){
+	if(slot->offset){
+		// the old field is too far away to be referenced so later references go to the new one
+		slot->offset = offset; 
+		return; 
+	}
+	if(keys->names_len + len > keys->names_cap){
+		size_t cap = keys->names_cap * 2 + len + 64; 
+		char *names = realloc(keys->names, cap); 
+		if(!names) return; 
+		keys->names = names; 
+		keys->names_cap = cap; 
+	}
+	memcpy(keys->names + keys->names_len, key, len); 
+	slot->hash = hash; 
+	slot->len = (uint32_t)len; 
+	slot->name = keys->names_len; 
+	slot->offset = offset; 
+	keys->names_len += len; 
+	keys->count++; 
+}
+
+bool blob_set_intern_keys(struct blob *buf, bool enable){
+	assert(buf); 
+	if(!enable){
+		if(buf->keys){
+			free(buf->keys->slots); 
+			free(buf->keys->names); 
+			free(buf->keys); 
+			buf->keys = NULL; 
+		}
+		return true; 
+	}
+	if(buf->flags & BLOB_FLAG_READONLY) return false; 
+	if(buf->keys) return true; 
+	struct blob_keys *keys = calloc(1, sizeof(struct blob_keys)); 
+	if(!keys) return false; 
+	keys->slots = calloc(BLOB_KEYS_MIN_SLOTS, sizeof(struct blob_key)); 
+	if(!keys->slots){
+		free(keys); 
+		return false; 
+	}
+	keys->size = BLOB_KEYS_MIN_SLOTS; 
+	buf->keys = keys; 
+	return true; 
+}
+
 void blob_reset(struct blob *buf){
 	assert(buf); 
+	blob_keys_clear(buf->keys); 
+	if(buf->flags & BLOB_FLAG_MEASURE){
+		buf->measured = sizeof(struct blob_field); 
+		return; 
+	}
 	assert(buf->buf); 
-	if(buf->memlen)
-		memset(buf->buf, 0, buf->memlen); 
-
+	if(buf->flags & BLOB_FLAG_READONLY) return; 
+	buf->pending = 0; 
+	// only the root header needs to be written, old content past it is never read again
 	blob_field_init(blob_head(buf), BLOB_FIELD_ARRAY, sizeof(struct blob_field)); 
 }
 
-void blob_init(struct blob *buf, const char *data, size_t size){
+void blob_init_alloc(struct blob *buf, const struct blob_allocator *alloc, const char *data, size_t size){
 	memset(buf, 0, sizeof(struct blob)); 
 
+	buf->alloc = (alloc)?alloc:blob_init_allocator; 
+
 	// default buffer is 256 bytes block with zero sized data
-	buf->memlen = (size > 0)?size:256; 
-	buf->buf = malloc(buf->memlen); 
+	buf->memlen = (size > 0)?size:BLOB_GROW_STEP; 
+	buf->buf = buf->alloc->alloc(buf->alloc->ctx, buf->memlen); 
 	assert(buf->buf); 
 	
 	if(data) {
@@ -91,51 +298,131 @@ void blob_init(struct blob *buf, const char *data, size_t size){
 	}
 }
 
+void blob_init(struct blob *buf, const char *data, size_t size){
+	blob_init_alloc(buf, NULL, data, size); 
+}
+
+void blob_init_measure(struct blob *buf){
+	memset(buf, 0, sizeof(struct blob)); 
+	// only used for temporary memory of the json parser
+	buf->alloc = blob_init_allocator; 
+	buf->flags = BLOB_FLAG_MEASURE; 
+	blob_reset(buf); 
+}
+
+size_t blob_measured_size(struct blob *buf){
+	assert(buf->flags & BLOB_FLAG_MEASURE); 
+	return buf->measured; 
+}
+
+bool blob_init_fixed(struct blob *buf, void *mem, size_t cap){
+	assert(mem); 
+	memset(buf, 0, sizeof(struct blob)); 
+	if(cap < sizeof(struct blob_field)) return false; 
+	buf->alloc = &blob_fixed_allocator; 
+	buf->buf = mem; 
+	buf->memlen = cap; 
+	blob_reset(buf); 
+	return true; 
+}
+
+bool blob_init_borrowed(struct blob *buf, const void *data, size_t size){
+	memset(buf, 0, sizeof(struct blob)); 
+	if(!data || ((uintptr_t)data & (BLOB_FIELD_ALIGN - 1))) return false; 
+	if(!blob_field_check(data, size)) return false; 
+	// the memory is never written to because of the read only flag
+	buf->alloc = &blob_fixed_allocator; 
+	buf->buf = (void*)(uintptr_t)data; 
+	buf->memlen = size; 
+	buf->flags = BLOB_FLAG_READONLY; 
+	return true; 
+}
+
+void *blob_detach(struct blob *buf, size_t *len, size_t *cap){
+	assert(buf); 
+	if(len) *len = 0; 
+	if(cap) *cap = 0; 
+	// the mapping is tied to the file (and its descriptor) so it can only be released with blob_free
+	if(blob_is_mapped(buf)) return NULL; 
+	void *mem = buf->buf; 
+	if(mem && len) *len = blob_size(buf); 
+	if(mem && cap) *cap = buf->memlen; 
+	buf->buf = NULL; 
+	buf->memlen = 0; 
+	blob_keys_clear(buf->keys); 
+	return mem; 
+}
+
+bool blob_check_head(const void *mem, size_t size){
+	if(!mem || size < sizeof(struct blob_field) || ((uintptr_t)mem & (BLOB_FIELD_ALIGN - 1))) return false; 
+	const struct blob_field *head = mem; 
+	if(blob_field_type(head) != BLOB_FIELD_ARRAY) return false; 
+	return blob_field_check_header(head, size); 
+}
+
+bool blob_adopt_alloc(struct blob *buf, const struct blob_allocator *alloc, void *mem, size_t cap){
+	memset(buf, 0, sizeof(struct blob)); 
+	// only the root header is checked so that adopting stays independent of the message size
+	if(!blob_check_head(mem, cap)) return false; 
+	// not the current default: the pool (or any other default) can not release memory it did not hand out
+	buf->alloc = (alloc)?alloc:&blob_default_allocator; 
+	buf->buf = mem; 
+	buf->memlen = cap; 
+	return true; 
+}
+
+bool blob_adopt(struct blob *buf, void *mem, size_t cap){
+	return blob_adopt_alloc(buf, NULL, mem, cap); 
+}
+
 void blob_free(struct blob *buf){
-	free(buf->buf);
+	if(buf->buf) buf->alloc->free(buf->alloc->ctx, buf->buf, buf->memlen);
 	buf->buf = NULL;
 	buf->memlen = 0;
+	blob_set_intern_keys(buf, false); 
 }
 
-static struct blob_field *blob_new_attr(struct blob *buf, int id, int payload){
-	int attr_raw_len = sizeof(struct blob_field) + payload; 
-	int attr_pad_len = attr_raw_len + (BLOB_FIELD_ALIGN - ( attr_raw_len % BLOB_FIELD_ALIGN)) % BLOB_FIELD_ALIGN; 
+// returned instead of a real field in measure mode so that callers still see success
+static struct blob_field blob_measure_field; 
 
-	struct blob_field *head = blob_head(buf); 
-	int cur_len = blob_field_raw_pad_len(head); 
-	int req_len = cur_len + attr_pad_len; 
+//! accounts for pad_len more bytes the same way blob_resize would grow the buffer
+static bool blob_measure(struct blob *buf, size_t pad_len){
+	size_t len = buf->measured + pad_len; 
+	// root gets extended header
+	if(buf->measured <= BLOB_FIELD_LEN_MASK && len > BLOB_FIELD_LEN_MASK) len += sizeof(uint64_t); 
+	if(len > blob_max_size(buf)) return false; 
+	buf->measured = len; 
+	return true; 
+}
 
-	if (!blob_resize(buf, req_len))
-		return NULL;
+//! grows the buffer by pad_len bytes and returns pointer to the new space at the end
+static struct blob_field *blob_alloc_attr(struct blob *buf, size_t pad_len){
+	if(buf->flags & BLOB_FLAG_MEASURE)
+		return (blob_measure(buf, pad_len))?&blob_measure_field:NULL; 
 
-	// cast to void* to ignore alignment warning since this is already handled above
-	struct blob_field *attr = (struct blob_field*)(void*)((char*)buf->buf + cur_len);
-	
-	blob_field_init(attr, id, attr_raw_len);
-	blob_field_fill_pad(attr);
+	size_t cur_len = blob_size(buf); 
 
-	// update the length of the head element to enclose the whole buffer
-	blob_field_set_raw_len(blob_head(buf), req_len); 
+	if (!blob_resize(buf, cur_len + pad_len))
+		return NULL;
 
-	return attr;
+	// the root may have been extended so we take the position from the new end of the buffer
+	// cast to void* to ignore alignment warning since this is already handled above
+	return (struct blob_field*)(void*)((char*)buf->buf + blob_size(buf) - pad_len);
 }
-/*
-struct blob_field *blob_put_binary(struct blob *buf, const void *ptr, unsigned int len){
-	assert(ptr); 
-	struct blob_field *attr;
 
-	if (len < sizeof(struct blob_field) || !ptr)
-		return NULL;
+static struct blob_field *blob_new_attr(struct blob *buf, int id, size_t payload){
+	size_t attr_raw_len = blob_attr_raw_len(payload); 
+	size_t attr_pad_len = blob_attr_pad_len(payload); 
 
-	attr = blob_new_attr(buf, BLOB_FIELD_BINARY, len - sizeof(struct blob_field));
-	if (!attr)
-		return NULL;
+	struct blob_field *attr = blob_alloc_attr(buf, attr_pad_len); 
+	if(!attr || attr == &blob_measure_field) return attr; 
+
+	blob_field_init(attr, id, attr_raw_len);
+	blob_field_fill_pad(attr);
 
-	memcpy(attr->data, ptr, len);
 	return attr;
 }
-*/
-static struct blob_field *blob_put(struct blob *buf, int id, const void *ptr, unsigned int len){
+static struct blob_field *blob_put(struct blob *buf, int id, const void *ptr, size_t len){
 	struct blob_field *attr;
 
 	attr = blob_new_attr(buf, id, len);
@@ -143,12 +430,83 @@ static struct blob_field *blob_put(struct blob *buf, int id, const void *ptr, un
 		return NULL;
 	}
 
+	if (attr == &blob_measure_field) return attr;
+
+	// reserved space is cleared so that old buffer contents never leak into the message
 	if (ptr)
-		memcpy(attr->data, ptr, len);
+		memcpy((char*)attr + blob_field_header_len(attr), ptr, len);
+	else
+		memset((char*)attr + blob_field_header_len(attr), 0, len);
 
 	return attr;
 }
 
+struct blob_field *blob_put_binary(struct blob *buf, const void *data, size_t size){
+	return blob_put(buf, BLOB_FIELD_BINARY, data, size);
+}
+
+struct blob_field *blob_put_stringn(struct blob *buf, const char *str, size_t len){
+	assert(str || !len); 
+	struct blob_field *attr = blob_put(buf, BLOB_FIELD_STRING, str, len + 1); 
+	if(!attr || attr == &blob_measure_field) return attr; 
+	((char*)attr + blob_field_header_len(attr))[len] = 0; 
+	return attr; 
+}
+
+//! allocates a field for up to maxlen bytes of data and remembers it until it is committed
+static void *blob_put_reserve(struct blob *buf, int id, size_t maxlen){
+	if(buf->flags & BLOB_FLAG_MEASURE) return NULL; 
+	struct blob_field *attr = blob_new_attr(buf, id, maxlen); 
+	if(!attr) return NULL; 
+	buf->pending = (size_t)((char*)attr - blob_offset_base(buf)); 
+	return (char*)attr + blob_field_header_len(attr); 
+}
+
+//! shrinks the reserved field to hold exactly len bytes of data
+static struct blob_field *blob_put_commit(struct blob *buf, int id, size_t len){
+	if(!buf->pending) return NULL; 
+	struct blob_field *attr = blob_offset_to_attr(buf, (blob_offset_t)buf->pending); 
+	struct blob_field *head = blob_head(buf); 
+	buf->pending = 0; 
+
+	// the reserved field must still be the last one in the buffer
+	if(blob_field_type(attr) != id || len > blob_field_data_len(attr) || 
+		(char*)attr + blob_field_raw_pad_len(attr) != (char*)head + blob_field_raw_len(head)) return NULL; 
+
+	// a reservation with extended header may now fit into a short one
+	size_t hdr_len = blob_field_header_len(attr); 
+	size_t raw_len = blob_attr_raw_len(len); 
+	size_t new_hdr_len = (raw_len > BLOB_FIELD_LEN_MASK)?BLOB_FIELD_EXTENDED_HDR_LEN:sizeof(struct blob_field); 
+	if(new_hdr_len != hdr_len) memmove((char*)attr + new_hdr_len, (char*)attr + hdr_len, len); 
+
+	blob_field_init(attr, id, raw_len); 
+	blob_field_fill_pad(attr); 
+
+	char *end = (char*)attr + blob_field_raw_pad_len(attr); 
+	blob_field_set_raw_len(head, (size_t)(end - (char*)buf->buf)); 
+	return attr; 
+}
+
+char *blob_put_string_reserve(struct blob *buf, size_t maxlen){
+	char *str = blob_put_reserve(buf, BLOB_FIELD_STRING, maxlen + 1); 
+	if(str) *str = 0; 
+	return str; 
+}
+
+struct blob_field *blob_put_string_commit(struct blob *buf, size_t len){
+	struct blob_field *attr = blob_put_commit(buf, BLOB_FIELD_STRING, len + 1); 
+	if(attr) ((char*)attr + blob_field_header_len(attr))[len] = 0; 
+	return attr; 
+}
+
+void *blob_put_binary_reserve(struct blob *buf, size_t maxlen){
+	return blob_put_reserve(buf, BLOB_FIELD_BINARY, maxlen); 
+}
+
+struct blob_field *blob_put_binary_commit(struct blob *buf, size_t len){
+	return blob_put_commit(buf, BLOB_FIELD_BINARY, len); 
+}
+
 struct blob_field *blob_put_string(struct blob *buf, const char *str){
 	assert(str); 
 	return blob_put(buf, BLOB_FIELD_STRING, str, strlen(str) + 1);
@@ -173,11 +531,26 @@ static struct blob_field *blob_put_u64(struct blob *buf, uint64_t val){
 	return blob_put(buf, BLOB_FIELD_INT64, &val, sizeof(val));
 }
 
+//! writes a header only field that holds the low 24 bits of value
+static struct blob_field *blob_put_inline(struct blob *buf, int id, int32_t value){
+	struct blob_field *attr = blob_alloc_attr(buf, sizeof(struct blob_field)); 
+	if(!attr || attr == &blob_measure_field) return attr; 
+	attr->id_len = htobe32((((uint32_t)id << BLOB_FIELD_ID_SHIFT) & BLOB_FIELD_ID_MASK) | ((uint32_t)value & BLOB_FIELD_LEN_MASK)); 
+	return attr; 
+}
+
 struct blob_field *blob_put_bool(struct blob *buf, bool val){
+	if(buf->flags & BLOB_FLAG_INLINE) return blob_put_inline(buf, BLOB_FIELD_BOOL, val); 
 	return blob_put_u8(buf, val); 
 }
 
+struct blob_field *blob_put_null(struct blob *buf){
+	if(buf->flags & BLOB_FLAG_INLINE) return blob_put_inline(buf, BLOB_FIELD_NULL, 0); 
+	return blob_put_u8(buf, 0); 
+}
+
 struct blob_field *blob_put_int(struct blob *self, long long val){
+	if((self->flags & BLOB_FLAG_INLINE) && val >= BLOB_FIELD_IMM_MIN && val <= BLOB_FIELD_IMM_MAX) return blob_put_inline(self, BLOB_FIELD_IMM, (int32_t)val); 
 	if(val >= INT8_MIN && val <= INT8_MAX) return blob_put_u8(self, val); 
 	if(val >= INT16_MIN && val <= INT16_MAX) return blob_put_u16(self, val); 
 	if(val >= INT32_MIN && val <= INT32_MAX) return blob_put_u32(self, val); 
@@ -185,28 +558,323 @@ struct blob_field *blob_put_int(struct blob *self, long long val){
 	return NULL; 
 }
 
-blob_offset_t blob_open_array(struct blob *buf){
-	struct blob_field *attr = blob_new_attr(buf, BLOB_FIELD_ARRAY, 0);
+//! returns offset the next field would have in measure mode
+static blob_offset_t blob_measure_offset(struct blob *buf){
+	// offsets do not count the length word of an extended root (see blob_offset_base)
+	size_t len = buf->measured; 
+	if(len > BLOB_FIELD_LEN_MASK) len -= sizeof(uint64_t); 
+	return (blob_offset_t)len; 
+}
+
+static blob_offset_t blob_open_attr(struct blob *buf, int id){
+	blob_offset_t offset = 0; 
+	if(buf->flags & BLOB_FLAG_MEASURE) offset = blob_measure_offset(buf); 
+	struct blob_field *attr = blob_new_attr(buf, id, 0);
+	if(!attr) return 0; 
+	if(attr == &blob_measure_field) return offset; 
 	return blob_field_to_offset(buf, attr);
 }
 
-void blob_close_array(struct blob *buf, blob_offset_t offset){
-	if((long)offset > (long)blob_size(buf)) return; 
+blob_offset_t blob_open_array(struct blob *buf){
+	return blob_open_attr(buf, BLOB_FIELD_ARRAY); 
+}
+
+//! points a key reference delta bytes back
+static void blob_keyref_set(struct blob_field *ref, size_t delta){
+	ref->id_len = htobe32(((uint32_t)BLOB_FIELD_KEYREF << BLOB_FIELD_ID_SHIFT) | (uint32_t)(delta / BLOB_FIELD_ALIGN)); 
+}
+
+//! adds shift to the key references among fields [pos, end) that point to strings in front of start. 
+//! Returns false if one would get too far away. Only checks without apply. 
+static bool blob_shift_refs(char *pos, const char *end, const char *start, size_t shift, bool apply){
+	while(pos < end){
+		struct blob_field *f = (struct blob_field*)(void*)pos; 
+		int type = blob_field_type(f); 
+		if(type == BLOB_FIELD_KEYREF){
+			size_t delta = (be32toh(f->id_len) & BLOB_FIELD_LEN_MASK) * BLOB_FIELD_ALIGN; 
+			if(delta > (size_t)(pos - start)){
+				if((delta + shift) / BLOB_FIELD_ALIGN > BLOB_FIELD_LEN_MASK) return false; 
+				if(apply) blob_keyref_set(f, delta + shift); 
+			}
+		} else if(type == BLOB_FIELD_ARRAY || type == BLOB_FIELD_TABLE){
+			if(!blob_shift_refs(pos + blob_field_header_len(f), pos + blob_field_raw_len(f), start, shift, apply)) return false; 
+		}
+		pos += blob_field_raw_pad_len(f); 
+	}
+	return true; 
+}
+
+//! moves everything that the blob remembers at or after offset from back by shift bytes
+static void blob_shift_offsets(struct blob *buf, size_t from, size_t shift){
+	for(size_t c = 0; buf->keys && c < buf->keys->size; c++){
+		struct blob_key *slot = &buf->keys->slots[c]; 
+		if(slot->offset >= from) slot->offset += shift; 
+	}
+	if(buf->pending >= from) buf->pending += shift; 
+}
+
+//! sets length of an open array or table to enclose everything written after it. Returns false if it could not be closed. 
+static bool blob_close_attr(struct blob *buf, blob_offset_t offset){
+	if(buf->flags & BLOB_FLAG_MEASURE){
+		if(!offset) return false; 
+		// a container that has grown over 16MB gets an extended header when it is closed
+		if((size_t)blob_measure_offset(buf) - (size_t)offset > BLOB_FIELD_LEN_MASK){
+			blob_measure(buf, sizeof(uint64_t)); 
+			blob_shift_offsets(buf, (size_t)offset + sizeof(struct blob_field), sizeof(uint64_t)); 
+		}
+		return true; 
+	}
+	if(!offset || (size_t)offset > blob_size(buf) || (buf->flags & BLOB_FLAG_READONLY)) return false; 
 	struct blob_field *attr = blob_offset_to_attr(buf, offset);
-	int len = ((char*)buf->buf + blob_field_raw_len(blob_head(buf))) - (char*)attr; 
+	size_t len = ((char*)buf->buf + blob_field_raw_len(blob_head(buf))) - (char*)attr; 
+	if(len > BLOB_FIELD_LEN_MASK && !blob_field_is_extended(attr)){
+		// the element has grown too large for a short header so we make room for the 64 bit length. 
+		// its content moves back which key references to strings in front of it have to follow. 
+		char *data = (char*)attr + sizeof(struct blob_field); 
+		if(!blob_shift_refs(data, (char*)attr + len, data, sizeof(uint64_t), false)) return false; 
+		if(!blob_resize(buf, blob_field_raw_len(blob_head(buf)) + sizeof(uint64_t))) return false; 
+		attr = blob_offset_to_attr(buf, offset); 
+		blob_field_extend(attr, len); 
+		data = (char*)attr + BLOB_FIELD_EXTENDED_HDR_LEN; 
+		blob_shift_refs(data, data + len - sizeof(struct blob_field), data, sizeof(uint64_t), true); 
+		blob_shift_offsets(buf, (size_t)offset + sizeof(struct blob_field), sizeof(uint64_t)); 
+		return true; 
+	}
 	blob_field_set_raw_len(attr, len);
+	return true; 
+}
+
+bool blob_close_array(struct blob *buf, blob_offset_t offset){
+	return blob_close_attr(buf, offset); 
+}
+
+//! writes a number field as element of a vector of the given type
+static void blob_vector_put_elem(char *out, int type, const struct blob_field *child){
+	switch(type){
+		case BLOB_FIELD_INT8: {
+			uint8_t v = blob_field_get_int(child); 
+			memcpy(out, &v, sizeof(v)); 
+		} break; 
+		case BLOB_FIELD_INT16: {
+			uint16_t v = htobe16(blob_field_get_int(child)); 
+			memcpy(out, &v, sizeof(v)); 
+		} break; 
+		case BLOB_FIELD_INT32: {
+			uint32_t v = htobe32(blob_field_get_int(child)); 
+			memcpy(out, &v, sizeof(v)); 
+		} break; 
+		case BLOB_FIELD_INT64: {
+			uint64_t v = htobe64(blob_field_get_int(child)); 
+			memcpy(out, &v, sizeof(v)); 
+		} break; 
+		case BLOB_FIELD_FLOAT32: {
+			float f = blob_field_get_real(child); 
+			uint32_t v; 
+			memcpy(&v, &f, sizeof(v)); 
+			v = htobe32(v); 
+			memcpy(out, &v, sizeof(v)); 
+		} break; 
+		case BLOB_FIELD_FLOAT64: {
+			double f = blob_field_get_real(child); 
+			uint64_t v; 
+			memcpy(&v, &f, sizeof(v)); 
+			v = htobe64(v); 
+			memcpy(out, &v, sizeof(v)); 
+		} break; 
+	}
+}
+
+bool blob_close_array_vector(struct blob *buf, blob_offset_t offset){
+	if(!blob_close_attr(buf, offset)) return false; 
+	// a measured array is counted as an array which is never smaller than the vector
+	if(!offset || (size_t)offset > blob_size(buf) || (buf->flags & (BLOB_FLAG_READONLY | BLOB_FLAG_MEASURE))) return true; 
+
+	struct blob_field *attr = blob_offset_to_attr(buf, offset); 
+	if(blob_field_type(attr) != BLOB_FIELD_ARRAY) return true; 
+
+	// the widest type of the children becomes the element type
+	int type = BLOB_FIELD_INVALID; 
+	bool ints = false, reals = false; 
+	size_t count = 0; 
+	const struct blob_field *child; 
+	blob_field_for_each_child(attr, child){
+		int t = blob_field_type(child); 
+		if(t >= BLOB_FIELD_INT8 && t <= BLOB_FIELD_INT64) ints = true; 
+		else if(t == BLOB_FIELD_FLOAT32 || t == BLOB_FIELD_FLOAT64) reals = true; 
+		else return true; 
+		if(t > type) type = t; 
+		count++; 
+	}
+	if(!count || (ints && reals)) return true; 
+
+	size_t size = blob_field_type_size(type); 
+	size_t raw_len = blob_attr_raw_len(BLOB_VECTOR_HDR_LEN + count * size); 
+	size_t hdr_len = (raw_len > BLOB_FIELD_LEN_MASK)?BLOB_FIELD_EXTENDED_HDR_LEN:sizeof(struct blob_field); 
+
+	// elements can be wider than the children they come from (a float widened to a double) so 
+	// writing over the array in place could destroy children that were not read yet. The elements 
+	// are collected in scratch memory first (see blob_scratch_alloc). 
+	char stack[256]; 
+	size_t len = count * size; 
+	char *tmp = blob_scratch_alloc(stack, sizeof(stack), len); 
+	// without scratch memory the array is simply kept
+	if(!tmp) return true; 
+	const char *pos = blob_field_data(attr); 
+	for(size_t c = 0; c < count; c++){
+		child = (const struct blob_field*)(const void*)pos; 
+		pos += blob_field_raw_pad_len(child); 
+		blob_vector_put_elem(tmp + c * size, type, child); 
+	}
+	// the vector is never larger than the array so it fits where the array was
+	memcpy((char*)attr + hdr_len + BLOB_VECTOR_HDR_LEN, tmp, len); 
+	blob_scratch_free(stack, tmp, len); 
+
+	blob_field_init(attr, BLOB_FIELD_VECTOR, raw_len); 
+	uint8_t *vhdr = (uint8_t*)attr + hdr_len; 
+	vhdr[0] = type; 
+	vhdr[1] = vhdr[2] = vhdr[3] = 0; 
+	blob_field_fill_pad(attr); 
+
+	// nothing follows the array so the buffer now ends with the vector
+	char *end = (char*)attr + blob_field_raw_pad_len(attr); 
+	blob_field_set_raw_len(blob_head(buf), (size_t)(end - (char*)buf->buf)); 
+	return true; 
 }
 
 blob_offset_t blob_open_table(struct blob *buf){
-	struct blob_field *attr = blob_new_attr(buf, BLOB_FIELD_TABLE, 0);
-	return blob_field_to_offset(buf, attr);
+	return blob_open_attr(buf, BLOB_FIELD_TABLE); 
 }
 
-void blob_close_table(struct blob *buf, blob_offset_t offset){
-	if((long)offset > (long)blob_size(buf)) return; 
-	struct blob_field *attr = blob_offset_to_attr(buf, offset);
-	int len = ((char*)buf->buf + blob_field_raw_len(blob_head(buf))) - (char*)attr; 
-	blob_field_set_raw_len(attr, len);
+bool blob_close_table(struct blob *buf, blob_offset_t offset){
+	return blob_close_attr(buf, offset); 
+}
+
+// a key/value pair of a table that is being sorted
+struct blob_sort_pair {
+	const char *key; 
+	size_t start; // offset of the pair from the start of the table data
+	size_t len; // length of key and value with padding
+	size_t moved; // offset of the pair once sorted
+	size_t index; // position of the pair before sorting
+}; 
+
+static int blob_sort_pair_cmp(const void *a, const void *b){
+	const struct blob_sort_pair *p1 = a, *p2 = b; 
+	int r = strcmp(p1->key, p2->key); 
+	if(r) return r; 
+	// pairs with equal keys keep their order so a key reference never ends up in front of its string
+	return (p1->index > p2->index) - (p1->index < p2->index); 
+}
+
+//! returns where byte pos of the table data ends up. order holds the pairs as they were before sorting. 
+static size_t blob_sort_map(struct blob_sort_pair **order, size_t count, size_t pos){
+	size_t lo = 0, hi = count; 
+	while(hi - lo > 1){
+		size_t mid = (lo + hi) / 2; 
+		if(order[mid]->start <= pos) lo = mid; else hi = mid; 
+	}
+	return pos - order[lo]->start + order[lo]->moved; 
+}
+
+//! rewrites the key references among fields [pos, end) of the old table data so they point to the same strings once the pairs have moved. 
+//! Returns false if a reference would no longer point backwards or be too far away. Only checks without apply. 
+static bool blob_sort_fix_refs(char *data, const char *old, size_t pos, size_t end, struct blob_sort_pair **order, size_t count, bool apply){
+	while(pos < end){
+		const struct blob_field *f = (const struct blob_field*)(const void*)(old + pos); 
+		int type = blob_field_type(f); 
+		if(type == BLOB_FIELD_KEYREF){
+			size_t delta = (be32toh(f->id_len) & BLOB_FIELD_LEN_MASK) * BLOB_FIELD_ALIGN; 
+			size_t moved = blob_sort_map(order, count, pos); 
+			if(delta > pos){
+				// the string is in front of the table and stays where it is
+				delta = delta - pos + moved; 
+			} else {
+				size_t target = blob_sort_map(order, count, pos - delta); 
+				if(target >= moved) return false; 
+				delta = moved - target; 
+			}
+			if(delta / BLOB_FIELD_ALIGN > BLOB_FIELD_LEN_MASK) return false; 
+			if(apply){
+				blob_keyref_set((struct blob_field*)(void*)(data + moved), delta); 
+			}
+		} else if(type == BLOB_FIELD_ARRAY || type == BLOB_FIELD_TABLE){
+			if(!blob_sort_fix_refs(data, old, pos + blob_field_header_len(f), pos + blob_field_raw_len(f), order, count, apply)) return false; 
+		}
+		pos += blob_field_raw_pad_len(f); 
+	}
+	return true; 
+}
+
+bool blob_close_table_sorted(struct blob *buf, blob_offset_t offset){
+	if(!blob_close_attr(buf, offset)) return false; 
+	// sorting never changes the size so a measured table is done
+	if(buf->flags & BLOB_FLAG_MEASURE) return true; 
+	if(!offset || (size_t)offset > blob_size(buf) || (buf->flags & BLOB_FLAG_READONLY)) return false; 
+	struct blob_field *attr = blob_offset_to_attr(buf, offset); 
+	if(blob_field_type(attr) != BLOB_FIELD_TABLE) return false; 
+
+	char *data = (char*)attr + blob_field_header_len(attr); 
+	size_t len = blob_field_data_len(attr); 
+	const char *end = data; 
+	size_t count = 0; 
+	bool sorted = true; 
+	const char *prev = NULL; 
+	const struct blob_field *key, *value; 
+	blob_field_for_each_kv(attr, key, value){
+		int type = blob_field_type(key); 
+		if(type != BLOB_FIELD_STRING && type != BLOB_FIELD_KEYREF) return false; 
+		const char *name = blob_field_get_string(key); 
+		if(prev && strcmp(prev, name) > 0) sorted = false; 
+		prev = name; 
+		end = (const char*)value + blob_field_raw_pad_len(value); 
+		count++; 
+	}
+	// a key without a value can not be moved around
+	if((size_t)(end - data) != len) return false; 
+
+	if(!sorted){
+		// pairs, their order and a copy of the table share one scratch block (see blob_scratch_alloc)
+		size_t pairs_size = count * sizeof(struct blob_sort_pair), order_size = count * sizeof(struct blob_sort_pair*); 
+		size_t scratch_size = pairs_size + order_size + len; 
+		struct blob_sort_pair stack[16]; 
+		char *scratch = blob_scratch_alloc(stack, sizeof(stack), scratch_size); 
+		if(!scratch) return false; 
+		struct blob_sort_pair *pairs = (struct blob_sort_pair*)(void*)scratch; 
+		struct blob_sort_pair **order = (struct blob_sort_pair**)(void*)(scratch + pairs_size); 
+		char *old = scratch + pairs_size + order_size; 
+		size_t c = 0; 
+		blob_field_for_each_kv(attr, key, value){
+			pairs[c].key = blob_field_get_string(key); 
+			pairs[c].start = (size_t)((const char*)key - data); 
+			pairs[c].len = (size_t)((const char*)value - (const char*)key) + blob_field_raw_pad_len(value); 
+			pairs[c].index = c; 
+			c++; 
+		}
+		qsort(pairs, count, sizeof(struct blob_sort_pair), blob_sort_pair_cmp); 
+		size_t pos = 0; 
+		for(c = 0; c < count; c++){
+			pairs[c].moved = pos; 
+			pos += pairs[c].len; 
+			order[pairs[c].index] = &pairs[c]; 
+		}
+		// key strings are read from the buffer so the pairs are only moved once all of them are known to fit
+		memcpy(old, data, len); 
+		bool ok = blob_sort_fix_refs(data, old, 0, len, order, count, false); 
+		if(ok){
+			for(c = 0; c < count; c++) memcpy(data + pairs[c].moved, old + pairs[c].start, pairs[c].len); 
+			blob_sort_fix_refs(data, old, 0, len, order, count, true); 
+			// later references must find the strings at their new place
+			size_t base = (size_t)(data - blob_offset_base(buf)); 
+			for(size_t s = 0; buf->keys && s < buf->keys->size; s++){
+				struct blob_key *slot = &buf->keys->slots[s]; 
+				if(slot->offset >= base && slot->offset < base + len) slot->offset = base + blob_sort_map(order, count, slot->offset - base); 
+			}
+		}
+		blob_scratch_free(stack, scratch, scratch_size); 
+		if(!ok) return false; 
+	}
+	attr->id_len |= htobe32(BLOB_FIELD_SORTED); 
+	return true; 
 }
 
 static struct blob_field *blob_put_float(struct blob *buf, double value){
@@ -227,16 +895,115 @@ struct blob_field *blob_put_real(struct blob *buf, double value){
 struct blob_field *blob_put_attr(struct blob *buf, const struct blob_field *attr){
 	if(!attr) return NULL; 
 	
-	size_t s =  blob_field_data_len(attr); 
-	struct blob_field *f = blob_new_attr(buf, blob_field_type(attr), s); 
-	memcpy(f, attr, blob_field_raw_pad_len(attr)); 
+	// a field of this blob moves with the buffer when it grows
+	const char *base = buf->buf; 
+	bool inside = base && (const char*)attr >= base && (const char*)attr < base + buf->memlen; 
+	size_t pos = (size_t)((const char*)attr - base); 
+
+	struct blob_field *f = blob_alloc_attr(buf, blob_field_copy_size(attr)); 
+	if(!f || f == &blob_measure_field) return f; 
+	if(inside) attr = (const struct blob_field*)(const void*)((const char*)buf->buf + pos); 
+	blob_field_copy_to(f, attr); 
 	return f; 
 }
 
+struct blob_field *blob_put_raw(struct blob *buf, int type, const void *data, size_t len){
+	if(type == BLOB_FIELD_KEYREF) return NULL; 
+	if(blob_type_is_inline(type)){
+		if(len > BLOB_FIELD_INLINE_LEN) return NULL; 
+		return blob_put_inline(buf, type, blob_field_inline_value(type, data, len)); 
+	}
+	return blob_put(buf, type, data, len); 
+}
+
+struct blob_field *blob_put_vector(struct blob *buf, int type, const void *values, size_t count){
+	size_t size = blob_field_type_size(type); 
+	if(!size) return NULL; 
+	struct blob_field *attr = blob_new_attr(buf, BLOB_FIELD_VECTOR, BLOB_VECTOR_HDR_LEN + size * count); 
+	if(!attr || attr == &blob_measure_field) return attr; 
+	uint8_t *vhdr = (uint8_t*)attr + blob_field_header_len(attr); 
+	vhdr[0] = type; 
+	vhdr[1] = vhdr[2] = vhdr[3] = 0; 
+	blob_field_vector_set(attr, values, count); 
+	return attr; 
+}
+
+//! allocates an array that holds content_len bytes of children and returns pointer to where the first child goes 
+static char *blob_new_array(struct blob *buf, size_t content_len, struct blob_field **array){
+	*array = blob_new_attr(buf, BLOB_FIELD_ARRAY, content_len); 
+	if(!*array || *array == &blob_measure_field) return NULL; 
+	return (char*)*array + blob_field_header_len(*array); 
+}
+
+struct blob_field *blob_put_int_array(struct blob *buf, const int64_t *values, size_t count){
+	size_t len = 0; 
+	bool inline_ok = !!(buf->flags & BLOB_FLAG_INLINE); 
+	for(size_t c = 0; c < count; c++) len += blob_attr_pad_len(blob_int_len(values[c], inline_ok)); 
+
+	struct blob_field *array; 
+	char *pos = blob_new_array(buf, len, &array); 
+	if(!pos) return array; 
+	for(size_t c = 0; c < count; c++) pos += blob_write_int(pos, values[c], inline_ok); 
+	return array; 
+}
+
+struct blob_field *blob_put_real_array(struct blob *buf, const double *values, size_t count){
+	size_t len = 0; 
+	for(size_t c = 0; c < count; c++) 
+		len += blob_attr_pad_len(blob_real_len(values[c])); 
+
+	struct blob_field *array; 
+	char *pos = blob_new_array(buf, len, &array); 
+	if(!pos) return array; 
+	for(size_t c = 0; c < count; c++) pos += blob_write_real(pos, values[c]); 
+	return array; 
+}
+
+struct blob_field *blob_put_string_array(struct blob *buf, const char *const *strings, size_t count){
+	size_t len = 0; 
+	for(size_t c = 0; c < count; c++) len += blob_attr_pad_len(strlen(strings[c]) + 1); 
+
+	struct blob_field *array; 
+	char *pos = blob_new_array(buf, len, &array); 
+	if(!pos) return array; 
+	for(size_t c = 0; c < count; c++) pos += blob_write_attr(pos, BLOB_FIELD_STRING, strings[c], strlen(strings[c]) + 1); 
+	return array; 
+}
+
+struct blob_field *blob_put_keyn(struct blob *buf, const char *key, size_t len){
+	struct blob_keys *keys = buf->keys; 
+	if(!keys) return blob_put_stringn(buf, key, len); 
+	// a full table would never end the probe so without more slots the key is simply written out
+	if(keys->count * 2 >= keys->size && !blob_keys_grow(keys)) return blob_put_stringn(buf, key, len); 
+
+	// offset the new field gets (offsets do not change when the root is extended)
+	size_t offset = (buf->flags & BLOB_FLAG_MEASURE)?(size_t)blob_measure_offset(buf):
+		(size_t)((char*)buf->buf + blob_size(buf) - blob_offset_base(buf)); 
+	uint32_t hash = blob_hash(key, len); 
+	struct blob_key *slot = blob_keys_find(keys, key, len, hash); 
+
+	// references count 4 byte units back from the reference to the string field
+	if(slot->offset && (offset - slot->offset) / BLOB_FIELD_ALIGN <= BLOB_FIELD_LEN_MASK)
+		return blob_put_inline(buf, BLOB_FIELD_KEYREF, (int32_t)((offset - slot->offset) / BLOB_FIELD_ALIGN)); 
+
+	struct blob_field *attr = blob_put_stringn(buf, key, len); 
+	if(attr) blob_keys_add(keys, slot, key, len, hash, offset); 
+	return attr; 
+}
+
+struct blob_field *blob_put_key(struct blob *buf, const char *key){
+	assert(key); 
+	return blob_put_keyn(buf, key, strlen(key)); 
+}
+
 static void __attribute__((unused)) _blob_field_dump(const struct blob_field *node, uint32_t indent){
 	static const char *names[] = {
 		[BLOB_FIELD_INVALID] = "BLOB_FIELD_INVALID",
 		[BLOB_FIELD_BINARY] = "BLOB_FIELD_BINARY",
+		[BLOB_FIELD_NULL] = "BLOB_FIELD_NULL",
+		[BLOB_FIELD_BOOL] = "BLOB_FIELD_BOOL",
+		[BLOB_FIELD_IMM] = "BLOB_FIELD_IMM",
+		[BLOB_FIELD_KEYREF] = "BLOB_FIELD_KEYREF",
 		[BLOB_FIELD_STRING] = "BLOB_FIELD_STRING",
 		[BLOB_FIELD_INT8] = "BLOB_FIELD_INT8",
 		[BLOB_FIELD_INT16] = "BLOB_FIELD_INT16",
@@ -245,7 +1012,9 @@ static void __attribute__((unused)) _blob_field_dump(const struct blob_field *no
 		[BLOB_FIELD_FLOAT32] = "BLOB_FIELD_FLOAT32", 
 		[BLOB_FIELD_FLOAT64] = "BLOB_FIELD_FLOAT64",
 		[BLOB_FIELD_ARRAY] = "BLOB_FIELD_ARRAY", 
-		[BLOB_FIELD_TABLE] = "BLOB_FIELD_TABLE"
+		[BLOB_FIELD_TABLE] = "BLOB_FIELD_TABLE", 
+		[BLOB_FIELD_ANY] = "BLOB_FIELD_ANY", 
+		[BLOB_FIELD_VECTOR] = "BLOB_FIELD_VECTOR"
 	}; 
 
 	for(const struct blob_field *attr = blob_field_first_child(node); attr; attr = blob_field_next_child(node, attr)){
@@ -260,7 +1029,7 @@ static void __attribute__((unused)) _blob_field_dump(const struct blob_field *no
 		for(uint32_t c = 0; c < sizeof(struct blob_field); c++){
 			printf("%02x", (int)*((const char*)attr + c) & 0xff); 
 		}
-		printf(") type=%s offset=%d full padded len: %d, header+data: %d, data len: %d ]\n", names[(id < BLOB_FIELD_LAST)?id:0], (int)offset, (int)len, (int)blob_field_raw_len(attr), blob_field_data_len(attr)); 
+		printf(") type=%s offset=%d full padded len: %d, header+data: %d, data len: %d ]\n", names[(id < BLOB_FIELD_LAST)?id:0], (int)offset, (int)len, (int)blob_field_raw_len(attr), (int)blob_field_data_len(attr)); 
 
 		if(id == BLOB_FIELD_ARRAY || id == BLOB_FIELD_TABLE) {
 			_blob_field_dump(attr, indent+1); 
@@ -28,7 +28,7 @@
 
 #include "blob_field.h"
 
-// arbitrary max size just to make sure we don't try to resize to a crazy value (should be something large yet reasonable!)
+// default max size just to make sure we don't try to resize to a crazy value (can be changed per blob with blob_set_max_size)
 #define BLOB_MAX_SIZE (10000000)
 
 /*
@@ -48,12 +48,164 @@ enum {
 	BLOB_FIELD_ARRAY, // only unnamed elements
 	BLOB_FIELD_TABLE, // only named elements
 	BLOB_FIELD_ANY, // to be used only as a wildcard
+	// types added later go after the wildcard so that the values above never change
+	BLOB_FIELD_VECTOR, // packed numbers of one type (see blob_put_vector)
+	BLOB_FIELD_NULL, // a null value (header only, see BLOB_FLAG_INLINE)
+	BLOB_FIELD_BOOL, // true or false stored in the header
+	BLOB_FIELD_IMM, // a signed 24 bit integer stored in the header
+	BLOB_FIELD_KEYREF, // a string written earlier in the same blob (header only, see blob_put_key)
 	BLOB_FIELD_LAST
 };
 
+//! returns true for types whose value is stored in the length bits of the header (the field is always 4 bytes)
+static inline bool blob_type_is_inline(int type){
+	return type == BLOB_FIELD_NULL || type == BLOB_FIELD_BOOL || type == BLOB_FIELD_IMM; 
+}
+
+//! returns true for types that consist of the header alone
+static inline bool blob_type_is_header_only(int type){
+	return blob_type_is_inline(type) || type == BLOB_FIELD_KEYREF; 
+}
+
+// range of integers that fit into a BLOB_FIELD_IMM
+#define BLOB_FIELD_IMM_MIN (-0x800000)
+#define BLOB_FIELD_IMM_MAX (0x7fffff)
+
+/*
+Hot field accessors are defined inline here so that walking a blob does not
+cost a library call per step. blob_field.c provides the exported copies of
+the same functions so programs linked against older headers keep working. 
+*/
+
+#if defined(__GNUC_GNU_INLINE__) && !defined(__cplusplus)
+// gnu89 inline semantics would emit a copy in every object file
+#define BLOB_INLINE extern inline __attribute__((gnu_inline))
+#else
+#define BLOB_INLINE inline
+#endif
+
+//! returns true if the field uses the extended (64 bit length) header
+BLOB_INLINE bool blob_field_is_extended(const struct blob_field *attr){
+	assert(attr); 
+	return !!(be32toh(attr->id_len) & BLOB_FIELD_EXTENDED); 
+}
+
+//! returns the type of the attribute 
+BLOB_INLINE uint8_t blob_field_type(const struct blob_field *attr){
+	if(!attr) return BLOB_FIELD_INVALID; 
+	return (uint8_t)((be32toh(attr->id_len) & BLOB_FIELD_ID_MASK) >> BLOB_FIELD_ID_SHIFT); 
+}
+
+//! returns length of the field header (4 bytes or 12 bytes for extended fields)
+BLOB_INLINE size_t blob_field_header_len(const struct blob_field *attr){
+	return (blob_field_is_extended(attr))?BLOB_FIELD_EXTENDED_HDR_LEN:sizeof(struct blob_field); 
+}
+
+//! returns full length of attribute
+BLOB_INLINE size_t blob_field_raw_len(const struct blob_field *attr){
+	assert(attr); 
+	uint32_t id_len = be32toh(attr->id_len); 
+	if(id_len & BLOB_FIELD_EXTENDED){
+		// the length word is only 4 byte aligned
+		uint64_t len; 
+		memcpy(&len, attr->data, sizeof(len)); 
+		return be64toh(len); 
+	}
+	// the length bits of header only fields hold the value (see blob_type_is_header_only)
+	uint32_t type = (id_len & BLOB_FIELD_ID_MASK) >> BLOB_FIELD_ID_SHIFT; 
+	if(type >= BLOB_FIELD_NULL && type <= BLOB_FIELD_KEYREF) return sizeof(struct blob_field); 
+	return (id_len & BLOB_FIELD_LEN_MASK); 
+}
+
+//! includes length of data of the attribute
+BLOB_INLINE size_t blob_field_data_len(const struct blob_field *attr){
+	return blob_field_raw_len(attr) - blob_field_header_len(attr); 
+}
+
+//! returns padded length of full attribute
+BLOB_INLINE size_t blob_field_raw_pad_len(const struct blob_field *attr){
+	return (blob_field_raw_len(attr) + BLOB_FIELD_ALIGN - 1) & ~(size_t)(BLOB_FIELD_ALIGN - 1); 
+}
+
+//! returns the data of the attribute
+BLOB_INLINE const void *blob_field_data(const struct blob_field *attr){
+	if(!attr) return NULL; 
+	return (const void *)((const char*)attr + blob_field_header_len(attr)); 
+}
+
+//! returns the first child of an array or table or NULL if it is empty
+BLOB_INLINE const struct blob_field *blob_field_first_child(const struct blob_field *self){
+	if(!self) return NULL; 
+	if(blob_field_raw_len(self) <= blob_field_header_len(self)) return NULL; 
+	return (const struct blob_field*)blob_field_data(self); 
+}
+
+//! returns the field following child inside of self or NULL after the last one
+BLOB_INLINE const struct blob_field *blob_field_next_child(const struct blob_field *self, const struct blob_field *child){
+	if(!child) return NULL; 
+	// cast to void* to supress alignment warning since blob boundaries are always aligned 	
+	const struct blob_field *ret = (const struct blob_field *)(const void*)((const char *) child + blob_field_raw_pad_len(child)); 
+	// check if we are still within bounds
+	size_t offset = (size_t)((const char*)ret - (const char*)self); 
+	if(offset >= blob_field_raw_pad_len(self)) return NULL; 
+	return ret; 
+}
+
+// default granularity in bytes of buffer reallocations
+#define BLOB_GROW_STEP (256)
+
+/*
+Growth policy used when the buffer needs more memory. Linear growth rounds each
+request up to the next grow step which keeps memory tight but makes building
+large blobs quadratic. Geometric growth (the default) at least doubles the
+memory area each time so the cost of building a blob is amortized linear. 
+*/
+enum blob_growth {
+	BLOB_GROWTH_GEOMETRIC, 
+	BLOB_GROWTH_LINEAR
+}; 
+
+/*
+Memory allocator used for the blob buffer. A blob is bound to an allocator when
+it is initialized and all memory of the buffer is then allocated, resized and
+released through it. Sizes of the previous allocation are always passed back to
+the allocator so that arenas and pools do not need to keep their own headers.  
+*/
+struct blob_allocator {
+	void *(*alloc)(void *ctx, size_t size); 
+	void *(*realloc)(void *ctx, void *ptr, size_t old_size, size_t new_size); 
+	void (*free)(void *ctx, void *ptr, size_t size); 
+	void *ctx; // passed as first argument to all of the above
+}; 
+
+//! allocator that uses malloc/realloc/free from the c library
+extern const struct blob_allocator blob_default_allocator; 
+
+//! Sets the allocator used by blob_init (NULL restores blob_default_allocator). Blobs keep the allocator they were initialized with. 
+void blob_set_default_allocator(const struct blob_allocator *alloc); 
+//! Returns the allocator currently used by blob_init
+const struct blob_allocator *blob_get_default_allocator(void); 
+
+// blob wraps memory that must not be modified (see blob_init_borrowed)
+#define BLOB_FLAG_READONLY (1 << 0)
+// blob only measures the size of what is written to it (see blob_init_measure)
+#define BLOB_FLAG_MEASURE (1 << 1)
+// nulls, bools and integers that fit into 24 bits are written as header only fields (see blob_set_inline)
+#define BLOB_FLAG_INLINE (1 << 2)
+
+struct blob_keys; 
+
 struct blob {
 	size_t memlen; // total length of the allocated memory area 
 	void *buf; // raw buffer data
+	const struct blob_allocator *alloc; // allocator of the memory area 
+	size_t max_size; // largest size the buffer may grow to (0 means BLOB_MAX_SIZE)
+	uint32_t grow_step; // reallocation granularity (0 means BLOB_GROW_STEP)
+	uint8_t growth; // growth policy (enum blob_growth) 
+	size_t measured; // size the buffer would have in measure mode
+	uint8_t flags; // BLOB_FLAG_*
+	size_t pending; // offset of a field reserved with blob_put_*_reserve that is not yet committed (0 if none)
+	struct blob_keys *keys; // dictionary of keys written with blob_put_key (NULL unless enabled with blob_set_intern_keys)
 };
 
 struct blob_policy {
@@ -64,12 +216,41 @@ struct blob_policy {
 
 //! Initializes a blob structure. Optionally takes memory area to be copied into the buffer which must represent a valid blob buf. 
 void blob_init(struct blob *buf, const char *data, size_t size);
+//! Same as blob_init but binds the blob to a custom allocator (NULL for default)
+void blob_init_alloc(struct blob *buf, const struct blob_allocator *alloc, const char *data, size_t size); 
+//! Initializes a blob that builds into caller provided memory (stack or static). The buffer never reallocates so writes that do not fit return NULL. Returns false if cap can not even hold the root element. 
+bool blob_init_fixed(struct blob *buf, void *mem, size_t cap); 
+//! Initializes a read only blob over caller owned memory without copying it (data must be 4 byte aligned and outlive the blob). All fields are bounds checked against size first. Returns false if data is not a valid blob. 
+bool blob_init_borrowed(struct blob *buf, const void *data, size_t size); 
+//! Initializes a blob that only measures. The same blob_put_*, blob_open_* and blob_close_* sequence succeeds as usual but writes and allocates nothing. The returned fields must not be accessed and blob_size can not be used. 
+void blob_init_measure(struct blob *buf); 
+//! Returns the exact size a measured sequence produces. Initializing the real blob with this size (blob_init(buf, NULL, size)) makes it allocate only once. 
+size_t blob_measured_size(struct blob *buf); 
+//! Returns true if mem starts with a root element that fits into size bytes. Children are not looked at (see blob_field_check). 
+bool blob_check_head(const void *mem, size_t size); 
+//! Releases the buffer to the caller without copying and returns it (len is set to the size of the message and cap to the size of the buffer). The blob is left empty like after blob_free. The memory must be released with the allocator of the blob (free() for the default allocator) and cap is the size to pass to its free and to blob_adopt_alloc. Mapped blobs (see blob_file.h) can not be detached: NULL is returned and the blob is left as it was. 
+void *blob_detach(struct blob *buf, size_t *len, size_t *cap); 
+//! Takes ownership of a buffer of cap bytes allocated with malloc() (blob_default_allocator, whatever blob_set_default_allocator installed). The buffer must start with a valid root element. Returns false (and leaves mem owned by the caller) if it does not. 
+bool blob_adopt(struct blob *buf, void *mem, size_t cap); 
+//! Same as blob_adopt for a buffer that was allocated with alloc (NULL for blob_default_allocator), for example one detached from a blob that uses the pool. 
+bool blob_adopt_alloc(struct blob *buf, const struct blob_allocator *alloc, void *mem, size_t cap); 
 //! Frees the memory allocated with the buffer
 void blob_free(struct blob *buf);
-//! Resets header but does not deallocate any memory.  
+//! Resets header but does not deallocate any memory. Cost does not depend on the size of the memory area. 
 void blob_reset(struct blob *buf);
-//! Resizes the buffer. Can only be used to increase size.  
-bool blob_resize(struct blob *buf, uint32_t newsize);
+//! Resizes the buffer. Can only be used to increase size. Fails if newsize is over the max size of the blob. 
+bool blob_resize(struct blob *buf, size_t newsize);
+//! Makes sure the buffer can hold at least size bytes without further reallocations. Allocates exactly size bytes if the buffer needs to grow. 
+bool blob_reserve(struct blob *buf, size_t size); 
+//! Sets the largest size the buffer may grow to (0 for BLOB_MAX_SIZE). Fields larger than 16MB are written with an extended header. 
+void blob_set_max_size(struct blob *buf, size_t size); 
+//! Enables writing nulls, bools and integers in [BLOB_FIELD_IMM_MIN, BLOB_FIELD_IMM_MAX] as header only fields. Off by default since readers built before these types can not read them. 
+void blob_set_inline(struct blob *buf, bool enable); 
+//! Enables the key dictionary of the blob. Every key written with blob_put_key after the first one with the same name then only takes a 4 byte reference to the first one. 
+//! References are relative to the field so a subtree that contains them is only valid inside the blob it was written to. blob_put_attr writes references to strings outside of the copied field out as strings. Returns false if the dictionary can not be allocated. 
+bool blob_set_intern_keys(struct blob *buf, bool enable); 
+//! Sets growth policy of the buffer. Step is the allocation granularity in bytes (0 for default). 
+void blob_set_growth(struct blob *buf, enum blob_growth policy, uint32_t step); 
 
 //! Returns pointer to header attribute (the first element) which is also raw buffer
 static inline struct blob_field *blob_head(struct blob *self){
@@ -81,7 +262,7 @@ static inline const struct blob_field *blob_head_const(const struct blob *self){
 }
 
 //! returns size of the whole buffer (including header element and padding)
-static inline uint32_t blob_size(struct blob *self){ return blob_field_raw_pad_len(blob_head(self)); }
+static inline size_t blob_size(struct blob *self){ return blob_field_raw_pad_len(blob_head(self)); }
 
 #ifdef __AVR
 typedef uint16_t blob_offset_t; 
@@ -93,14 +274,18 @@ typedef void* blob_offset_t;
 ** NESTED ELEMENTS 
 ********************************/
 
-//! opens an array element
+//! opens an array element (returns 0 if the element does not fit)
 blob_offset_t 	blob_open_array(struct blob *buf);
-//! closes an array element
-void 			blob_close_array(struct blob *buf, blob_offset_t);
-//! opens an table element
+//! closes an array element. Returns false if offset is not an open element or a container over 16MB could not get its extended header (it then stays open). 
+bool 			blob_close_array(struct blob *buf, blob_offset_t);
+//! closes an array and turns it into a vector if it only holds integers or only holds reals (otherwise same as blob_close_array). Returns true once the array is closed whether it was converted or not: arrays of other fields and arrays over 256 bytes of elements for which the default allocator gives no scratch memory stay arrays. Check blob_field_type of the field to find out. 
+bool 			blob_close_array_vector(struct blob *buf, blob_offset_t); 
+//! opens an table element (returns 0 if the element does not fit)
 blob_offset_t 	blob_open_table(struct blob *buf);
-//! closes an table element
-void 			blob_close_table(struct blob *buf, blob_offset_t);
+//! closes an table element (see blob_close_array)
+bool 			blob_close_table(struct blob *buf, blob_offset_t);
+//! closes a table and sorts its pairs by key (see blob_table_find). Returns false if the table could not be closed or was closed but left unsorted because a key is not a string, a key reference could not be kept pointing backwards or there was no scratch memory. Small tables are sorted on the stack and larger ones with memory from blob_default_allocator whatever allocator the blob uses, so fixed, borrowed and mapped blobs are sorted too but can fail like any other when malloc fails. 
+bool 			blob_close_table_sorted(struct blob *buf, blob_offset_t); 
 
 /********************************
 ** WRITING FUNCTIONS
@@ -122,13 +307,32 @@ struct blob_field *blob_put_u64(struct blob *buf, uint64_t val);
 //! write a boolean into the buffer
 struct blob_field *blob_put_bool(struct blob *buf, bool val); 
 
+//! write the key of a table entry (a string, or a reference to the same key written before if the key dictionary is enabled)
+struct blob_field *blob_put_key(struct blob *buf, const char *key); 
+//! same as blob_put_key for a key of len characters
+struct blob_field *blob_put_keyn(struct blob *buf, const char *key, size_t len); 
+
+//! write a null into the buffer (an int8 zero unless inline values are enabled)
+struct blob_field *blob_put_null(struct blob *buf); 
+
 //! write a string into the buffer
 struct blob_field *blob_put_string(struct blob *buf, const char *str); 
 
-//! write binary data into the buffer
-// NOTE: binary no longer supported because it is not representable in json and also because for binary data we actually need a whole new field type since we need to use size and our blob size is always padded. 
-// for binary use an array with integers instead
-//struct blob_field *blob_put_binary(struct blob *buf, const void *data, unsigned int size); 
+//! write binary data into the buffer. The field records the exact size of the data (padding is not counted). 
+//! If data is NULL the space is reserved and zeroed and can be filled in through the returned field. 
+struct blob_field *blob_put_binary(struct blob *buf, const void *data, size_t size); 
+//! write a string of len characters (str does not need to be terminated and strlen is not called)
+struct blob_field *blob_put_stringn(struct blob *buf, const char *str, size_t len); 
+
+//! Reserves room for a string of up to maxlen characters at the end of the buffer and returns a pointer to it that can be written to directly (for example with snprintf). 
+//! Nothing else may be written to the buffer until blob_put_string_commit is called. Returns NULL if the space can not be allocated or in measure mode (measure with blob_put_stringn). 
+char *blob_put_string_reserve(struct blob *buf, size_t maxlen); 
+//! Finishes a reserved string that is len characters long (len <= maxlen). The string is terminated and the field and buffer are shrunk to fit. 
+struct blob_field *blob_put_string_commit(struct blob *buf, size_t len); 
+//! same as blob_put_string_reserve but for binary data of up to maxlen bytes
+void *blob_put_binary_reserve(struct blob *buf, size_t maxlen); 
+//! finishes a reserved binary field that holds len bytes (len <= maxlen)
+struct blob_field *blob_put_binary_commit(struct blob *buf, size_t len); 
 
 //! write a number into the buffer
 struct blob_field *blob_put_int(struct blob *buf, long long val); 
@@ -136,9 +340,24 @@ struct blob_field *blob_put_int(struct blob *buf, long long val);
 //! write a real into the buffer
 struct blob_field *blob_put_real(struct blob *buf, double value); 
 
-//! write a raw attribute into the buffer
+//! write a vector of count numbers of one type (BLOB_FIELD_INT8 .. BLOB_FIELD_FLOAT64). Values are a native array of the matching type (int8_t .. int64_t, float, double). 
+struct blob_field *blob_put_vector(struct blob *buf, int type, const void *values, size_t count); 
+
+//! write a raw attribute into the buffer (key references to strings outside of attr are written out as strings, see blob_field_copy_to)
 struct blob_field *blob_put_attr(struct blob *buf, const struct blob_field *attr); 
 
+//! write a field of the given type with len bytes of already encoded (big endian) data
+struct blob_field *blob_put_raw(struct blob *buf, int type, const void *data, size_t len); 
+
+//! write an array of numbers (same result as blob_put_int for each value inside an array but with only one resize)
+struct blob_field *blob_put_int_array(struct blob *buf, const int64_t *values, size_t count); 
+
+//! write an array of reals (same result as blob_put_real for each value inside an array but with only one resize)
+struct blob_field *blob_put_real_array(struct blob *buf, const double *values, size_t count); 
+
+//! write an array of strings (same result as blob_put_string for each string inside an array but with only one resize)
+struct blob_field *blob_put_string_array(struct blob *buf, const char *const *strings, size_t count); 
+
 //! print out the whole buffer 
 void blob_dump(struct blob *self); 
 
@@ -0,0 +1,159 @@
+/*
+ 	Copyright (C) 2015 Martin Schröder <mkschreder.uk@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "blob_arena.h"
+
+#define BLOB_ARENA_ALIGN 8
+
+struct blob_arena_block {
+	struct blob_arena_block *next; 
+	size_t size; // usable size of data
+	size_t used; // bytes handed out so far
+	char data[]; 
+}; 
+
+static inline size_t blob_arena_align(size_t size){
+	return (size + BLOB_ARENA_ALIGN - 1) & ~(size_t)(BLOB_ARENA_ALIGN - 1); 
+}
+
+//! returns true if ptr is the last allocation in the current block
+static bool blob_arena_is_last(struct blob_arena *self, void *ptr){
+	struct blob_arena_block *b = self->block; 
+	return ptr && ptr == self->last && b && (char*)ptr >= b->data && (char*)ptr < b->data + b->size; 
+}
+
+//! returns the block of ptr if it is the most recent allocation that did not fit into a regular block
+static struct blob_arena_block *blob_arena_is_large(struct blob_arena *self, void *ptr){
+	struct blob_arena_block *b = self->large; 
+	return (ptr && b && ptr == b->data)?b:NULL; 
+}
+
+//! gives an allocation larger than a block a block of its own so the current block keeps being filled
+static void *blob_arena_alloc_large(struct blob_arena *self, size_t size){
+	struct blob_arena_block *b = malloc(sizeof(struct blob_arena_block) + size); 
+	if(!b) return NULL; 
+	b->size = b->used = size; 
+	b->next = self->large; 
+	self->large = b; 
+	return b->data; 
+}
+
+static void *blob_arena_alloc(void *ctx, size_t size){
+	struct blob_arena *self = ctx; 
+	struct blob_arena_block *b = self->block; 
+	size = blob_arena_align(size); 
+
+	if(size > self->block_size) return blob_arena_alloc_large(self, size); 
+
+	if(!b || b->used + size > b->size){
+		b = malloc(sizeof(struct blob_arena_block) + self->block_size); 
+		if(!b) return NULL; 
+		b->size = self->block_size; 
+		b->used = 0; 
+		b->next = self->block; 
+		self->block = b; 
+	}
+
+	void *ptr = b->data + b->used; 
+	b->used += size; 
+	self->prev = self->last; 
+	self->last = ptr; 
+	return ptr; 
+}
+
+static void *blob_arena_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size){
+	struct blob_arena *self = ctx; 
+	struct blob_arena_block *b = self->block; 
+
+	if(!ptr) return blob_arena_alloc(ctx, new_size); 
+
+	// the most recent large allocation has its block to itself so the c library can resize it
+	struct blob_arena_block *large = blob_arena_is_large(self, ptr); 
+	if(large){
+		size_t size = blob_arena_align(new_size); 
+		large = realloc(large, sizeof(struct blob_arena_block) + size); 
+		if(!large) return NULL; 
+		large->size = large->used = size; 
+		self->large = large; 
+		return large->data; 
+	}
+
+	// the last allocation is extended (or shrunk) in place as long as the block has room
+	if(blob_arena_is_last(self, ptr)){
+		size_t offset = (size_t)((char*)ptr - b->data); 
+		if(offset + blob_arena_align(new_size) <= b->size){
+			b->used = offset + blob_arena_align(new_size); 
+			return ptr; 
+		}
+	}
+
+	void *new = blob_arena_alloc(ctx, new_size); 
+	if(!new) return NULL; 
+	memcpy(new, ptr, (old_size < new_size)?old_size:new_size); 
+	return new; 
+}
+
+static void blob_arena_release(void *ctx, void *ptr, size_t size){
+	struct blob_arena *self = ctx; 
+	struct blob_arena_block *large = blob_arena_is_large(self, ptr); 
+	if(large){
+		self->large = large->next; 
+		free(large); 
+		return; 
+	}
+	// only the last allocation can be given back, everything else is released on reset
+	if(!blob_arena_is_last(self, ptr)) return; 
+	self->block->used = (size_t)((char*)ptr - self->block->data); 
+	self->last = self->prev; 
+	self->prev = NULL; 
+}
+
+void blob_arena_init(struct blob_arena *self, size_t block_size){
+	memset(self, 0, sizeof(*self)); 
+	self->block_size = (block_size)?block_size:BLOB_ARENA_BLOCK_SIZE; 
+	self->allocator.alloc = blob_arena_alloc; 
+	self->allocator.realloc = blob_arena_realloc; 
+	self->allocator.free = blob_arena_release; 
+	self->allocator.ctx = self; 
+}
+
+static void blob_arena_free_blocks(struct blob_arena_block *b){
+	while(b){
+		struct blob_arena_block *next = b->next; 
+		free(b); 
+		b = next; 
+	}
+}
+
+void blob_arena_reset(struct blob_arena *self){
+	// keep the current block so that the next request does not need to allocate
+	if(self->block){
+		blob_arena_free_blocks(self->block->next); 
+		self->block->next = NULL; 
+		self->block->used = 0; 
+	}
+	blob_arena_free_blocks(self->large); 
+	self->large = NULL; 
+	self->last = self->prev = NULL; 
+}
+
+void blob_arena_free(struct blob_arena *self){
+	blob_arena_free_blocks(self->block); 
+	blob_arena_free_blocks(self->large); 
+	self->block = self->large = NULL; 
+	self->last = self->prev = NULL; 
+}
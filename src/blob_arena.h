@@ -0,0 +1,57 @@
+/*
+ 	Copyright (C) 2015 Martin Schröder <mkschreder.uk@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "blob.h"
+
+// default size of memory blocks that the arena allocates from the system
+#define BLOB_ARENA_BLOCK_SIZE (64 * 1024)
+
+/*
+An arena hands out memory for many short lived blobs using bump allocation.
+The most recently allocated buffer can be grown in place so a blob that is
+being built last never gets copied. Memory of individual blobs is not reused
+until the whole arena is reset (typically at the end of a request). 
+
+Allocations larger than a block get a block of their own that is kept apart
+from the regular ones, so the arena keeps bumping from its current block and
+the last blob there can still grow in place. The most recent large allocation
+is resized and freed with the c library. 
+*/
+
+struct blob_arena_block; 
+
+struct blob_arena {
+	struct blob_allocator allocator; // allocator interface bound to this arena
+	struct blob_arena_block *block; // current block (older blocks are linked behind it)
+	struct blob_arena_block *large; // blocks of allocations larger than block_size (most recent first)
+	size_t block_size; // size of newly allocated blocks
+	void *last; // last allocation which can still be resized in place
+	void *prev; // allocation made before last (restored when last is freed)
+}; 
+
+//! Initializes an empty arena. Block size of 0 means BLOB_ARENA_BLOCK_SIZE. 
+void blob_arena_init(struct blob_arena *self, size_t block_size); 
+//! Releases all memory handed out by the arena. Keeps one block for reuse. All blobs allocated from the arena become invalid. 
+void blob_arena_reset(struct blob_arena *self); 
+//! Frees all memory of the arena
+void blob_arena_free(struct blob_arena *self); 
+
+//! Initializes a blob (see blob_init) which allocates its memory from the arena
+static inline void blob_init_arena(struct blob *buf, struct blob_arena *arena, const char *data, size_t size){
+	blob_init_alloc(buf, &arena->allocator, data, size); 
+}
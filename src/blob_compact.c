@@ -0,0 +1,322 @@
+/*
+ 	Copyright (C) 2015 Martin Schröder <mkschreder.uk@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include "blob_compact.h"
+
+// tag values that mean the length follows the tag in 1, 2, 4 or 8 bytes
+#define BLOB_COMPACT_LEN_INLINE (12)
+#define BLOB_COMPACT_MAGIC_LEN (2)
+
+//! returns number of bytes the tag and length take
+static size_t blob_compact_hdr_len(size_t len){
+	if(len < BLOB_COMPACT_LEN_INLINE) return 1; 
+	if(len <= 0xff) return 2; 
+	if(len <= 0xffff) return 3; 
+	if(len <= 0xffffffff) return 5; 
+	return 9; 
+}
+
+//! writes tag and length to out and returns the number of bytes written
+static size_t blob_compact_put_hdr(uint8_t *out, int type, size_t len){
+	size_t hdr_len = blob_compact_hdr_len(len); 
+	if(hdr_len == 1){
+		out[0] = (uint8_t)((type << 4) | len); 
+		return 1; 
+	}
+	// 2 -> 12, 3 -> 13, 5 -> 14, 9 -> 15
+	static const uint8_t codes[] = { [2] = 12, [3] = 13, [5] = 14, [9] = 15 }; 
+	out[0] = (uint8_t)((type << 4) | codes[hdr_len]); 
+	for(size_t c = hdr_len - 1; c > 0; c--){
+		out[c] = (uint8_t)len; 
+		len >>= 8; 
+	}
+	return hdr_len; 
+}
+
+//! reads tag and length at pos into value. Returns false if the field does not end before end. 
+static bool blob_compact_get_hdr(const uint8_t *pos, const uint8_t *end, struct blob_value *value){
+	if(pos >= end) return false; 
+	uint8_t tag = *pos++; 
+	size_t len = tag & 0x0f; 
+	if(len >= BLOB_COMPACT_LEN_INLINE){
+		size_t bytes = (size_t)1 << (len - BLOB_COMPACT_LEN_INLINE); 
+		if((size_t)(end - pos) < bytes) return false; 
+		len = 0; 
+		for(size_t c = 0; c < bytes; c++) len = (len << 8) | *pos++; 
+	}
+	if((size_t)(end - pos) < len) return false; 
+	value->type = tag >> 4; 
+	value->data = pos; 
+	value->len = len; 
+	value->next = pos + len; 
+	value->compact = true; 
+	return true; 
+}
+
+static bool blob_is_container(int type){
+	return type == BLOB_FIELD_ARRAY || type == BLOB_FIELD_TABLE; 
+}
+
+//! returns the bytes of the value of an inline field without leading sign bytes (0 to 3)
+static size_t blob_compact_inline_data(const struct blob_field *attr, const uint8_t **data){
+	// the value is in the low three bytes of the big endian header
+	const uint8_t *value = (const uint8_t*)attr + 1; 
+	size_t len = BLOB_FIELD_INLINE_LEN; 
+	int type = blob_field_type(attr); 
+	while(len && blob_field_inline_value(type, value + 1, len - 1) == blob_field_inline_value(type, value, len)){
+		value++; 
+		len--; 
+	}
+	*data = value; 
+	return len; 
+}
+
+//! returns length of the data of attr in compact encoding
+static size_t blob_compact_data_len(const struct blob_field *attr){
+	// key references are written as the string they refer to
+	if(blob_field_type(attr) == BLOB_FIELD_KEYREF) return strlen(blob_field_get_string(attr)) + 1; 
+	if(blob_type_is_inline(blob_field_type(attr))){
+		const uint8_t *data; 
+		return blob_compact_inline_data(attr, &data); 
+	}
+	if(!blob_is_container(blob_field_type(attr))) return blob_field_data_len(attr); 
+	size_t len = 0; 
+	const struct blob_field *child; 
+	blob_field_for_each_child(attr, child){
+		size_t child_len = blob_compact_data_len(child); 
+		len += blob_compact_hdr_len(child_len) + child_len; 
+	}
+	return len; 
+}
+
+//! Writes attr to out and returns end of the written data or NULL if it does not fit before end. 
+//! With exact set the length of every container is computed before it is written. 
+static uint8_t *blob_compact_put_field(uint8_t *out, const uint8_t *end, const struct blob_field *attr, bool exact){
+	int type = blob_field_type(attr); 
+	size_t len = blob_field_data_len(attr); 
+	if(exact && blob_is_container(type)) len = blob_compact_data_len(attr); 
+	size_t hdr_len = blob_compact_hdr_len(len); 
+	if((size_t)(end - out) < hdr_len) return NULL; 
+	if(!blob_is_container(type)){
+		const uint8_t *data = blob_field_data(attr); 
+		if(type == BLOB_FIELD_KEYREF){
+			type = BLOB_FIELD_STRING; 
+			data = (const uint8_t*)blob_field_get_string(attr); 
+			len = strlen((const char*)data) + 1; 
+			hdr_len = blob_compact_hdr_len(len); 
+		}
+		if(blob_type_is_inline(type)){
+			len = blob_compact_inline_data(attr, &data); 
+			hdr_len = 1; 
+		}
+		if((size_t)(end - out) < hdr_len + len) return NULL; 
+		out += blob_compact_put_hdr(out, type, len); 
+		memcpy(out, data, len); 
+		return out + len; 
+	}
+
+	// Otherwise children are written after room for a header as long as the regular data needs. This almost 
+	// always has the size of the compact header so nothing is moved and nested containers are only walked once. 
+	uint8_t *pos = out + hdr_len; 
+	const struct blob_field *child; 
+	blob_field_for_each_child(attr, child){
+		if(!(pos = blob_compact_put_field(pos, end, child, exact))) return NULL; 
+	}
+	len = (size_t)(pos - out) - hdr_len; 
+	size_t new_hdr_len = blob_compact_hdr_len(len); 
+	if(new_hdr_len != hdr_len){
+		if(new_hdr_len > hdr_len && (size_t)(end - pos) < new_hdr_len - hdr_len) return NULL; 
+		memmove(out + new_hdr_len, out + hdr_len, len); 
+	}
+	blob_compact_put_hdr(out, type, len); 
+	return out + new_hdr_len + len; 
+}
+
+bool blob_is_compact(const void *data, size_t size){
+	const uint8_t *mem = data; 
+	return mem && size >= BLOB_COMPACT_MAGIC_LEN && mem[0] == BLOB_COMPACT_MAGIC_0 && mem[1] == BLOB_COMPACT_MAGIC_1; 
+}
+
+size_t blob_compact_size(const struct blob_field *root){
+	assert(root); 
+	size_t len = blob_compact_data_len(root); 
+	return BLOB_COMPACT_MAGIC_LEN + blob_compact_hdr_len(len) + len; 
+}
+
+size_t blob_compact_encode(const struct blob_field *root, void *out, size_t size){
+	assert(root && out); 
+	uint8_t *pos = out; 
+	const uint8_t *end = pos + size; 
+	if(size < BLOB_COMPACT_MAGIC_LEN) return 0; 
+	*pos++ = BLOB_COMPACT_MAGIC_0; 
+	*pos++ = BLOB_COMPACT_MAGIC_1; 
+	uint8_t *last = blob_compact_put_field(pos, end, root, false); 
+	// a header that shrinks later needs a few more bytes while writing so a buffer of exactly the right size is written again with exact lengths
+	if(!last && size >= blob_compact_size(root)) last = blob_compact_put_field(pos, end, root, true); 
+	if(!last) return 0; 
+	return (size_t)(last - (uint8_t*)out); 
+}
+
+static bool blob_compact_check_value(const struct blob_value *value, int depth){
+	if(!blob_is_container(value->type)) return blob_field_check_data(value->type, value->data, value->len); 
+	if(depth >= BLOB_FIELD_MAX_DEPTH) return false; 
+	const uint8_t *end = value->data + value->len; 
+	struct blob_value child; 
+	for(const uint8_t *pos = value->data; pos < end; pos = child.next){
+		if(!blob_compact_get_hdr(pos, end, &child) || !blob_compact_check_value(&child, depth + 1)) return false; 
+	}
+	return true; 
+}
+
+bool blob_compact_check(const void *data, size_t size){
+	struct blob_value root; 
+	if(!blob_is_compact(data, size)) return false; 
+	const uint8_t *end = (const uint8_t*)data + size; 
+	if(!blob_compact_get_hdr((const uint8_t*)data + BLOB_COMPACT_MAGIC_LEN, end, &root)) return false; 
+	return root.type == BLOB_FIELD_ARRAY && blob_compact_check_value(&root, 0); 
+}
+
+static bool blob_compact_put_value(struct blob *buf, const struct blob_value *value){
+	if(!blob_is_container(value->type)) return blob_put_raw(buf, value->type, value->data, value->len) != NULL; 
+
+	blob_offset_t offset = (value->type == BLOB_FIELD_TABLE)?blob_open_table(buf):blob_open_array(buf); 
+	if(!offset) return false; 
+	struct blob_value child; 
+	for(bool ok = blob_value_first_child(value, &child); ok; ok = blob_value_next_child(value, &child)){
+		if(!blob_compact_put_value(buf, &child)) return false; 
+	}
+	if(value->type == BLOB_FIELD_TABLE) blob_close_table(buf, offset); 
+	else blob_close_array(buf, offset); 
+	return true; 
+}
+
+bool blob_compact_decode(struct blob *buf, const void *data, size_t size){
+	struct blob_value root, child; 
+	if(!blob_compact_check(data, size)) return false; 
+	blob_value_init(&root, data, size); 
+
+	blob_reset(buf); 
+	for(bool ok = blob_value_first_child(&root, &child); ok; ok = blob_value_next_child(&root, &child)){
+		if(!blob_compact_put_value(buf, &child)) return false; 
+	}
+	return true; 
+}
+
+//! fills value from a field in the regular format
+static void blob_value_from_field(struct blob_value *value, const struct blob_field *attr){
+	value->type = blob_field_type(attr); 
+	value->data = blob_field_data(attr); 
+	value->len = blob_field_data_len(attr); 
+	if(blob_type_is_inline(value->type)){
+		// the value is in the low three bytes of the header
+		value->data = (const uint8_t*)attr + 1; 
+		value->len = BLOB_FIELD_INLINE_LEN; 
+	}
+	if(value->type == BLOB_FIELD_KEYREF){
+		// looks like the string it refers to
+		const char *str = blob_field_get_string(attr); 
+		value->type = BLOB_FIELD_STRING; 
+		value->data = (const uint8_t*)str; 
+		value->len = strlen(str) + 1; 
+	}
+	value->next = (const uint8_t*)attr + blob_field_raw_pad_len(attr); 
+	value->compact = false; 
+}
+
+bool blob_value_init(struct blob_value *self, const void *data, size_t size){
+	memset(self, 0, sizeof(*self)); 
+	if(blob_is_compact(data, size)){
+		if(!blob_compact_check(data, size)) return false; 
+		return blob_compact_get_hdr((const uint8_t*)data + BLOB_COMPACT_MAGIC_LEN, (const uint8_t*)data + size, self); 
+	}
+	// regular blobs are aligned so the cast is safe once the pointer is checked
+	if(!data || ((uintptr_t)data & (BLOB_FIELD_ALIGN - 1))) return false; 
+	const struct blob_field *root = data; 
+	if(!blob_field_check(root, size)) return false; 
+	blob_value_from_field(self, root); 
+	return true; 
+}
+
+//! reads the field at pos into child if it lies within self
+static bool blob_value_read(const struct blob_value *self, const uint8_t *pos, struct blob_value *child){
+	const uint8_t *end = self->data + self->len; 
+	if(!blob_is_container(self->type) || pos >= end) return false; 
+	if(self->compact) return blob_compact_get_hdr(pos, end, child); 
+	blob_value_from_field(child, (const struct blob_field*)(const void*)pos); 
+	return true; 
+}
+
+bool blob_value_first_child(const struct blob_value *self, struct blob_value *child){
+	return blob_value_read(self, self->data, child); 
+}
+
+bool blob_value_next_child(const struct blob_value *self, struct blob_value *child){
+	return blob_value_read(self, child->next, child); 
+}
+
+//! reads a big endian number of len bytes
+static uint64_t blob_value_get_be(const uint8_t *data, size_t len){
+	uint64_t val = 0; 
+	for(size_t c = 0; c < len; c++) val = (val << 8) | data[c]; 
+	return val; 
+}
+
+long long blob_value_get_int(const struct blob_value *self){
+	switch(self->type){
+		case BLOB_FIELD_NULL: 
+		case BLOB_FIELD_BOOL: 
+		case BLOB_FIELD_IMM: 
+			return blob_field_inline_value(self->type, self->data, self->len); 
+		case BLOB_FIELD_INT8: return (int8_t)blob_value_get_be(self->data, 1); 
+		case BLOB_FIELD_INT16: return (int16_t)blob_value_get_be(self->data, 2); 
+		case BLOB_FIELD_INT32: return (int32_t)blob_value_get_be(self->data, 4); 
+		case BLOB_FIELD_INT64: return (int64_t)blob_value_get_be(self->data, 8); 
+		case BLOB_FIELD_FLOAT32: 
+		case BLOB_FIELD_FLOAT64: 
+			return (long long)blob_value_get_real(self); 
+		case BLOB_FIELD_STRING: {
+			long long val = 0; 
+			sscanf((const char*)self->data, "%lli", &val); 
+			return val; 
+		}
+	}
+	return 0; 
+}
+
+double blob_value_get_real(const struct blob_value *self){
+	switch(self->type){
+		case BLOB_FIELD_FLOAT32: return unpack754_32((uint32_t)blob_value_get_be(self->data, 4)); 
+		case BLOB_FIELD_FLOAT64: return unpack754_64(blob_value_get_be(self->data, 8)); 
+		case BLOB_FIELD_STRING: {
+			double val = 0; 
+			sscanf((const char*)self->data, "%lf", &val); 
+			return val; 
+		}
+	}
+	return (double)blob_value_get_int(self); 
+}
+
+const char *blob_value_get_string(const struct blob_value *self){
+	if(self->type != BLOB_FIELD_STRING) return NULL; 
+	return (const char*)self->data; 
+}
+
+const void *blob_value_get_binary(const struct blob_value *self, size_t *len){
+	if(len) *len = self->len; 
+	return self->data; 
+}
@@ -0,0 +1,78 @@
+/*
+ 	Copyright (C) 2015 Martin Schröder <mkschreder.uk@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "blob.h"
+
+// first two bytes of a compact message. A regular blob always starts with the header of an array so it never starts with 0xff. 
+#define BLOB_COMPACT_MAGIC_0 (0xff)
+#define BLOB_COMPACT_MAGIC_1 ('2')
+
+/*
+Compact (v2) wire encoding. Every field starts with one tag byte that holds the
+type in the upper four bits and the length of the data in the lower four bits.
+Lengths of 0-11 are stored in the tag itself. 12, 13, 14 and 15 mean that the
+length follows the tag as a big endian number of 1, 2, 4 or 8 bytes. Data is
+the same as in the regular format (big endian numbers, terminated strings and
+vectors with their element header) but nothing is padded. Arrays and tables
+hold their children back to back.
+
+An int8 takes 2 bytes instead of 8 and a key like "id" takes 4 bytes instead of 8.
+
+The compact form is meant for the wire. Blobs are always built in the regular
+format (which needs aligned headers to close containers in place) and are
+converted with blob_compact_encode() when sent and blob_compact_decode() when
+received. struct blob_value reads either format directly without converting.
+*/
+
+//! returns true if data starts with the compact magic
+bool blob_is_compact(const void *data, size_t size); 
+//! returns number of bytes the compact encoding of the message in root takes (including the magic)
+size_t blob_compact_size(const struct blob_field *root); 
+//! writes compact encoding of root into out. Returns the number of bytes written or 0 if it does not fit into size bytes. 
+size_t blob_compact_encode(const struct blob_field *root, void *out, size_t size); 
+//! replaces content of buf with the message in compact data of size bytes. Returns false if data is not a valid compact message. 
+bool blob_compact_decode(struct blob *buf, const void *data, size_t size); 
+//! checks that a compact message and all of its fields lie within size bytes and that values have the right length for their type (nesting is limited like in blob_field_check)
+bool blob_compact_check(const void *data, size_t size); 
+
+//! a field in either wire format
+struct blob_value {
+	const uint8_t *data; // data of the field
+	size_t len; // length of data
+	const uint8_t *next; // where the next field in the same container starts
+	uint8_t type; 
+	bool compact; // data is in compact encoding
+}; 
+
+//! Opens a message in either format for reading (the format is detected from the magic). The whole message is checked first so malformed data returns false. 
+bool blob_value_init(struct blob_value *self, const void *data, size_t size); 
+//! reads first child of an array or table into child. Returns false if there are none. 
+bool blob_value_first_child(const struct blob_value *self, struct blob_value *child); 
+//! moves child to the next field of self. Returns false at the end. 
+bool blob_value_next_child(const struct blob_value *self, struct blob_value *child); 
+
+static inline int blob_value_type(const struct blob_value *self){ return self->type; }
+//! returns value of a number field (same conversions as blob_field_get_int)
+long long blob_value_get_int(const struct blob_value *self); 
+//! returns value of a number field (same conversions as blob_field_get_real)
+double blob_value_get_real(const struct blob_value *self); 
+//! returns value of a string field (NULL for other types)
+const char *blob_value_get_string(const struct blob_value *self); 
+//! returns data of a binary field and stores its length in len
+const void *blob_value_get_binary(const struct blob_value *self, size_t *len); 
@@ -19,6 +19,18 @@
 #include <endian.h>
 #include "blob.h"
 #include "blob_field.h"
+#include "blob_private.h"
+
+// exported copies of the accessors that blob.h defines inline
+extern inline const void *blob_field_data(const struct blob_field *attr); 
+extern inline uint8_t blob_field_type(const struct blob_field *attr); 
+extern inline bool blob_field_is_extended(const struct blob_field *attr); 
+extern inline size_t blob_field_header_len(const struct blob_field *attr); 
+extern inline size_t blob_field_raw_len(const struct blob_field *attr); 
+extern inline size_t blob_field_data_len(const struct blob_field *attr); 
+extern inline size_t blob_field_raw_pad_len(const struct blob_field *attr); 
+extern inline const struct blob_field *blob_field_first_child(const struct blob_field *self); 
+extern inline const struct blob_field *blob_field_next_child(const struct blob_field *self, const struct blob_field *child); 
 
 static const int blob_type_minlen[BLOB_FIELD_LAST] = {
 	[BLOB_FIELD_STRING] = 1,
@@ -26,6 +38,8 @@ static const int blob_type_minlen[BLOB_FIELD_LAST] = {
 	[BLOB_FIELD_INT16] = sizeof(uint16_t),
 	[BLOB_FIELD_INT32] = sizeof(uint32_t),
 	[BLOB_FIELD_INT64] = sizeof(uint64_t),
+	[BLOB_FIELD_FLOAT32] = sizeof(uint32_t),
+	[BLOB_FIELD_FLOAT64] = sizeof(uint64_t),
 };
 
 /*const char *blob_field_name(struct blob_field *attr){
@@ -36,41 +50,138 @@ static const int blob_type_minlen[BLOB_FIELD_LAST] = {
 void blob_field_fill_pad(struct blob_field *attr) {
 	if(!attr) return; 
 	char *buf = (char *) attr;
-	int len = blob_field_raw_pad_len(attr);
-	int delta = len - blob_field_raw_len(attr);
+	size_t len = blob_field_raw_pad_len(attr);
+	size_t delta = len - blob_field_raw_len(attr);
 
 	if (delta > 0)
 		memset(buf + len - delta, 0, delta);
 }
 
-void blob_field_set_raw_len(struct blob_field *attr, uint32_t len){
+void blob_field_set_raw_len(struct blob_field *attr, size_t len){
 	if(!attr) return; 
+	if(blob_field_is_extended(attr)){
+		uint64_t ext = htobe64(len); 
+		memcpy(attr->data, &ext, sizeof(ext)); 
+		return; 
+	}
 	if(len < sizeof(struct blob_field)) len = sizeof(struct blob_field);
+	assert(len <= BLOB_FIELD_LEN_MASK); 
 	len &= BLOB_FIELD_LEN_MASK;
 	attr->id_len &= ~htobe32(BLOB_FIELD_LEN_MASK);
 	attr->id_len |= htobe32(len);
 }
-/*
-bool blob_field_check_type(const void *ptr, unsigned int len, int type){
-	const char *data = ptr;
+bool blob_field_check_data(int type, const void *ptr, size_t len){
+	const char *data = ptr; 
 
-	if (type >= BLOB_FIELD_LAST)
+	if (type < 0 || type >= BLOB_FIELD_LAST || type == BLOB_FIELD_ANY || type == BLOB_FIELD_KEYREF)
 		return false;
 
-	if (type >= BLOB_FIELD_INT8 && type <= BLOB_FIELD_INT64) {
-		if (len != blob_type_minlen[type])
+	if (type >= BLOB_FIELD_INT8 && type <= BLOB_FIELD_FLOAT64) {
+		if (len != (size_t)blob_type_minlen[type])
 			return false;
 	} else {
-		if (len < blob_type_minlen[type])
+		if (len < (size_t)blob_type_minlen[type])
 			return false;
 	}
 
 	if (type == BLOB_FIELD_STRING && data[len - 1] != 0)
 		return false;
 
+	if (blob_type_is_inline(type)) {
+		if (len > BLOB_FIELD_INLINE_LEN)
+			return false;
+		int32_t value = blob_field_inline_value(type, data, len);
+		if ((type == BLOB_FIELD_BOOL && value > 1) || (type == BLOB_FIELD_NULL && value != 0))
+			return false;
+	}
+
+	if (type == BLOB_FIELD_VECTOR) {
+		if (len < BLOB_VECTOR_HDR_LEN)
+			return false;
+		size_t size = blob_field_type_size(*(const uint8_t*)data);
+		if (!size || (len - BLOB_VECTOR_HDR_LEN) % size)
+			return false;
+	}
+
 	return true;
 }
-*/
+
+//! checks that the data of a value field is long enough for its type
+static bool blob_field_check_type(const struct blob_field *attr){
+	int type = blob_field_type(attr); 
+	// the value of an inline field is in the low three bytes of the header
+	if(blob_type_is_inline(type)) return blob_field_check_data(type, (const char*)attr + 1, BLOB_FIELD_INLINE_LEN); 
+	return blob_field_check_data(type, blob_field_data(attr), blob_field_data_len(attr)); 
+}
+
+int32_t blob_field_inline_value(int type, const void *data, size_t len){
+	const uint8_t *bytes = data; 
+	uint32_t value = 0; 
+	for(size_t c = 0; c < len; c++) value = (value << 8) | bytes[c]; 
+	// only immediate integers are signed
+	if(type == BLOB_FIELD_IMM && len && (value & (1u << (len * 8 - 1)))) value |= ~0u << (len * 8); 
+	return (int32_t)value; 
+}
+
+//! returns the value stored in the length bits of an inline field
+static int32_t blob_field_get_inline(const struct blob_field *attr){
+	uint32_t value = be32toh(attr->id_len) & BLOB_FIELD_LEN_MASK; 
+	if(blob_field_type(attr) == BLOB_FIELD_IMM && (value & 0x800000)) value |= ~(uint32_t)BLOB_FIELD_LEN_MASK; 
+	return (int32_t)value; 
+}
+
+//! returns the string field a key reference points to
+static const struct blob_field *blob_field_keyref_target(const struct blob_field *attr){
+	size_t delta = (be32toh(attr->id_len) & BLOB_FIELD_LEN_MASK) * BLOB_FIELD_ALIGN; 
+	return (const struct blob_field*)(const void*)((const char*)attr - delta); 
+}
+
+//! checks that a key reference points to a valid string between start and itself
+static bool blob_field_check_keyref(const struct blob_field *attr, const char *start){
+	size_t delta = (be32toh(attr->id_len) & BLOB_FIELD_LEN_MASK) * BLOB_FIELD_ALIGN; 
+	if(!delta || delta > (size_t)((const char*)attr - start)) return false; 
+	const struct blob_field *target = blob_field_keyref_target(attr); 
+	if(blob_field_type(target) != BLOB_FIELD_STRING) return false; 
+	if(blob_field_is_extended(target) && delta < BLOB_FIELD_EXTENDED_HDR_LEN) return false; 
+	if(blob_field_raw_pad_len(target) > delta || blob_field_raw_len(target) < blob_field_header_len(target)) return false; 
+	return blob_field_check_type(target); 
+}
+
+bool blob_field_check_header(const struct blob_field *attr, size_t size){
+	if(!attr || size < sizeof(struct blob_field)) return false; 
+	if(blob_field_is_extended(attr)){
+		// the old format used the top bit for named fields whose short size is never zero
+		if(be32toh(attr->id_len) & BLOB_FIELD_LEN_MASK) return false; 
+		if(size < BLOB_FIELD_EXTENDED_HDR_LEN) return false; 
+	}
+	return blob_field_raw_len(attr) >= blob_field_header_len(attr) && blob_field_raw_pad_len(attr) <= size; 
+}
+
+//! start is the beginning of the message which key references may point back to, depth the number of containers around attr
+static bool _blob_field_check(const struct blob_field *attr, size_t size, const char *start, int depth){
+	if(!blob_field_check_header(attr, size)) return false; 
+
+	int type = blob_field_type(attr); 
+	if(blob_field_is_sorted(attr) && type != BLOB_FIELD_TABLE) return false; 
+	if(type == BLOB_FIELD_KEYREF) return blob_field_check_keyref(attr, start); 
+	if(type != BLOB_FIELD_ARRAY && type != BLOB_FIELD_TABLE) return blob_field_check_type(attr); 
+	// the check recurses so a hostile message could otherwise exhaust the stack
+	if(depth >= BLOB_FIELD_MAX_DEPTH) return false; 
+
+	const char *end = (const char*)attr + blob_field_raw_len(attr); 
+	const char *pos = blob_field_data(attr); 
+	while(pos < end){
+		// cast to void* to supress alignment warning since children are always aligned 
+		const struct blob_field *child = (const struct blob_field*)(const void*)pos; 
+		if(!_blob_field_check(child, (size_t)(end - pos), start, depth + 1)) return false; 
+		pos += blob_field_raw_pad_len(child); 
+	}
+	return true; 
+}
+
+bool blob_field_check(const struct blob_field *attr, size_t size){
+	return _blob_field_check(attr, size, (const char*)attr, 0); 
+}
 
 bool
 blob_field_equal(const struct blob_field *a1, const struct blob_field *a2){
@@ -89,10 +200,67 @@ blob_field_equal(const struct blob_field *a1, const struct blob_field *a2){
 	return !memcmp(a1, a2, blob_field_raw_pad_len(a1));
 }
 
-//! returns the data of the attribute
-const void *blob_field_data(const struct blob_field *attr){
-	if(!attr) return NULL; 
-	return (const void *) attr->data;
+//! true if a key reference among the children of attr points to a string in front of start
+static bool blob_field_has_outer_refs(const struct blob_field *attr, const char *start){
+	const struct blob_field *child; 
+	blob_field_for_each_child(attr, child){
+		int type = blob_field_type(child); 
+		if(type == BLOB_FIELD_KEYREF && (const char*)blob_field_keyref_target(child) < start) return true; 
+		if((type == BLOB_FIELD_ARRAY || type == BLOB_FIELD_TABLE) && blob_field_has_outer_refs(child, start)) return true; 
+	}
+	return false; 
+}
+
+//! writes attr to out with every key reference replaced by its string (only measures if out is NULL)
+static size_t blob_field_expand_to(char *out, const struct blob_field *attr){
+	int type = blob_field_type(attr); 
+	if(type == BLOB_FIELD_KEYREF){
+		const char *str = blob_field_get_string(attr); 
+		size_t raw_len = sizeof(struct blob_field) + strlen(str) + 1; 
+		if(out){
+			struct blob_field *f = (struct blob_field*)(void*)out; 
+			f->id_len = htobe32((((uint32_t)BLOB_FIELD_STRING << BLOB_FIELD_ID_SHIFT) & BLOB_FIELD_ID_MASK) | raw_len); 
+			memcpy(f->data, str, raw_len - sizeof(struct blob_field)); 
+			blob_field_fill_pad(f); 
+		}
+		return (raw_len + BLOB_FIELD_ALIGN - 1) & ~(size_t)(BLOB_FIELD_ALIGN - 1); 
+	}
+	if(type != BLOB_FIELD_ARRAY && type != BLOB_FIELD_TABLE){
+		if(out) memcpy(out, attr, blob_field_raw_pad_len(attr)); 
+		return blob_field_raw_pad_len(attr); 
+	}
+	const struct blob_field *child; 
+	size_t len = 0; 
+	blob_field_for_each_child(attr, child) len += blob_field_expand_to(NULL, child); 
+	size_t hdr_len = (sizeof(struct blob_field) + len > BLOB_FIELD_LEN_MASK)?BLOB_FIELD_EXTENDED_HDR_LEN:sizeof(struct blob_field); 
+	if(!out) return hdr_len + len; 
+
+	// the sorted flag stays valid because the keys themselves do not change
+	struct blob_field *f = (struct blob_field*)(void*)out; 
+	uint32_t id_len = be32toh(attr->id_len) & (BLOB_FIELD_ID_MASK | BLOB_FIELD_SORTED); 
+	if(hdr_len != sizeof(struct blob_field)) id_len |= BLOB_FIELD_EXTENDED; 
+	f->id_len = htobe32(id_len); 
+	blob_field_set_raw_len(f, hdr_len + len); 
+	char *pos = out + hdr_len; 
+	blob_field_for_each_child(attr, child) pos += blob_field_expand_to(pos, child); 
+	return hdr_len + len; 
+}
+
+size_t blob_field_copy_size(const struct blob_field *attr){
+	int type = blob_field_type(attr); 
+	if((type == BLOB_FIELD_ARRAY || type == BLOB_FIELD_TABLE) && blob_field_has_outer_refs(attr, (const char*)attr)) 
+		return blob_field_expand_to(NULL, attr); 
+	return blob_field_raw_pad_len(attr); 
+}
+
+size_t blob_field_copy_to(void *out, const struct blob_field *attr){
+	int type = blob_field_type(attr); 
+	// references would point at whatever is in front of the copy so they are written out as strings. 
+	// all of them are because expanding one changes the distance of the others to their strings. 
+	if((type == BLOB_FIELD_ARRAY || type == BLOB_FIELD_TABLE) && blob_field_has_outer_refs(attr, (const char*)attr)) 
+		return blob_field_expand_to(out, attr); 
+	memcpy(out, attr, blob_field_raw_pad_len(attr)); 
+	return blob_field_raw_pad_len(attr); 
 }
 
 /*
@@ -112,7 +280,7 @@ struct blob_field *blob_field_copy(struct blob_field *attr){
 
 static uint8_t blob_field_get_u8(const struct blob_field *attr){
 	assert(attr); 
-	return *((const uint8_t *) attr->data);
+	return *((const uint8_t *) blob_field_data(attr));
 }
 /*
 void blob_field_set_u8(const struct blob_field *attr, uint8_t val){
@@ -122,7 +290,7 @@ void blob_field_set_u8(const struct blob_field *attr, uint8_t val){
 */
 static uint16_t blob_field_get_u16(const struct blob_field *attr){
 	assert(attr);
-	const uint16_t *tmp = (const uint16_t*)(const void*)attr->data;
+	const uint16_t *tmp = (const uint16_t*)blob_field_data(attr);
 	return be16toh(*tmp);
 }
 /*
@@ -135,7 +303,7 @@ blob_field_set_u16(const struct blob_field *attr, uint16_t val){
 */
 static uint32_t blob_field_get_u32(const struct blob_field *attr){
 	assert(attr); 
-	const uint32_t *tmp = (const uint32_t*)(const void*)attr->data;
+	const uint32_t *tmp = (const uint32_t*)blob_field_data(attr);
 	return be32toh(*tmp);
 }
 /*
@@ -213,9 +381,14 @@ long long blob_field_get_int(const struct blob_field *self){
 		case BLOB_FIELD_INT64: return blob_field_get_i64(self); 
 		case BLOB_FIELD_FLOAT32: return blob_field_get_f32(self); 
 		case BLOB_FIELD_FLOAT64: return blob_field_get_f64(self); 
+		case BLOB_FIELD_NULL: 
+		case BLOB_FIELD_BOOL: 
+		case BLOB_FIELD_IMM: 
+			return blob_field_get_inline(self); 
+		case BLOB_FIELD_KEYREF: 
 		case BLOB_FIELD_STRING: {
 			long long val; 
-			sscanf(self->data, "%lli", &val); 
+			sscanf(blob_field_get_string(self), "%lli", &val); 
 			return val; 
 		} 
 	}
@@ -232,9 +405,14 @@ double blob_field_get_real(const struct blob_field *self){
 		case BLOB_FIELD_INT64: return blob_field_get_i64(self); 
 		case BLOB_FIELD_FLOAT32: return blob_field_get_f32(self); 
 		case BLOB_FIELD_FLOAT64: return blob_field_get_f64(self); 
+		case BLOB_FIELD_NULL: 
+		case BLOB_FIELD_BOOL: 
+		case BLOB_FIELD_IMM: 
+			return blob_field_get_inline(self); 
+		case BLOB_FIELD_KEYREF: 
 		case BLOB_FIELD_STRING: {
 			double val; 
-			sscanf(self->data, "%lf", &val); 
+			sscanf(blob_field_get_string(self), "%lf", &val); 
 			return val; 
 		} 
 	}
@@ -249,71 +427,142 @@ bool blob_field_get_bool(const struct blob_field *self){
 const char *
 blob_field_get_string(const struct blob_field *attr){
 	if(!attr) return NULL; 
-	return attr->data;
+	if(blob_field_type(attr) == BLOB_FIELD_KEYREF) return blob_field_data(blob_field_keyref_target(attr)); 
+	return blob_field_data(attr);
 }
 
-/*
-size_t blob_field_get_raw(const struct blob_field *attr, uint8_t *data, size_t data_size){
-	assert(attr); 
-	size_t s = blob_field_size(attr); 
-	if(data_size > s) data_size = s; 
-	memcpy(data, attr->data, data_size); 
-	return data_size; 
+const void *blob_field_get_binary(const struct blob_field *attr, size_t *len){
+	if(!attr) {
+		if(len) *len = 0; 
+		return NULL; 
+	}
+	if(len) *len = blob_field_data_len(attr); 
+	return blob_field_data(attr); 
 }
-*/
 
-//! returns the type of the attribute 
-uint8_t blob_field_type(const struct blob_field *attr){
-	if(!attr) return BLOB_FIELD_INVALID; 
-	int id = (be32toh(attr->id_len) & BLOB_FIELD_ID_MASK) >> BLOB_FIELD_ID_SHIFT;
-	return id;
+size_t blob_field_type_size(int type){
+	switch(type){
+		case BLOB_FIELD_INT8: return sizeof(uint8_t); 
+		case BLOB_FIELD_INT16: return sizeof(uint16_t); 
+		case BLOB_FIELD_INT32: 
+		case BLOB_FIELD_FLOAT32: return sizeof(uint32_t); 
+		case BLOB_FIELD_INT64: 
+		case BLOB_FIELD_FLOAT64: return sizeof(uint64_t); 
+	}
+	return 0; 
 }
-/*
-void blob_field_set_type(struct blob_field *self, int type){
-	assert(self); 
-	int id_len = be32toh(self->id_len); 
-	id_len = (id_len & ~BLOB_FIELD_ID_MASK) | (type << BLOB_FIELD_ID_SHIFT); 	
-	self->id_len = htobe32(id_len);
+
+int blob_field_vector_type(const struct blob_field *attr){
+	if(blob_field_type(attr) != BLOB_FIELD_VECTOR) return BLOB_FIELD_INVALID; 
+	return *(const uint8_t*)blob_field_data(attr); 
+}
+
+size_t blob_field_vector_count(const struct blob_field *attr){
+	size_t size = blob_field_type_size(blob_field_vector_type(attr)); 
+	if(!size) return 0; 
+	return (blob_field_data_len(attr) - BLOB_VECTOR_HDR_LEN) / size; 
 }
+
+static inline const char *blob_field_vector_data(const struct blob_field *attr){
+	return (const char*)blob_field_data(attr) + BLOB_VECTOR_HDR_LEN; 
+}
+
+/*
+Elements are stored in network byte order right after each other. Floats are
+stored as their ieee 754 bit pattern. Elements are only guaranteed to be 4 byte
+aligned so they are always accessed through memcpy. These loops are simple
+enough for the compiler to vectorize the byte swapping. The same function
+converts in both directions. 
 */
-//! returns full length of attribute
-unsigned int
-blob_field_raw_len(const struct blob_field *attr){
-	assert(attr); 
-	return (be32toh(attr->id_len) & BLOB_FIELD_LEN_MASK); 
+static void blob_vector_swap(void *dst, const void *src, size_t size, size_t count){
+	char *d = dst; 
+	const char *s = src; 
+	switch(size){
+		case sizeof(uint16_t): 
+			for(size_t c = 0; c < count; c++){
+				uint16_t v; 
+				memcpy(&v, s + c * sizeof(v), sizeof(v)); 
+				v = be16toh(v); 
+				memcpy(d + c * sizeof(v), &v, sizeof(v)); 
+			}
+			break; 
+		case sizeof(uint32_t): 
+			for(size_t c = 0; c < count; c++){
+				uint32_t v; 
+				memcpy(&v, s + c * sizeof(v), sizeof(v)); 
+				v = be32toh(v); 
+				memcpy(d + c * sizeof(v), &v, sizeof(v)); 
+			}
+			break; 
+		case sizeof(uint64_t): 
+			for(size_t c = 0; c < count; c++){
+				uint64_t v; 
+				memcpy(&v, s + c * sizeof(v), sizeof(v)); 
+				v = be64toh(v); 
+				memcpy(d + c * sizeof(v), &v, sizeof(v)); 
+			}
+			break; 
+		default: 
+			memcpy(d, s, size * count); 
+	}
 }
 
-//! includes length of data of the attribute
-unsigned int
-blob_field_data_len(const struct blob_field *attr){
-	assert(attr); 
-	return blob_field_raw_len(attr) - sizeof(struct blob_field);
+size_t blob_field_vector_copy(const struct blob_field *attr, void *values, size_t count){
+	size_t n = blob_field_vector_count(attr); 
+	if(count > n) count = n; 
+	blob_vector_swap(values, blob_field_vector_data(attr), blob_field_type_size(blob_field_vector_type(attr)), count); 
+	return count; 
 }
 
-//! returns padded length of full attribute
-uint32_t 
-blob_field_raw_pad_len(const struct blob_field *attr){
-	assert(attr); 
-	uint32_t len = blob_field_raw_len(attr);
-	len = (len + BLOB_FIELD_ALIGN - 1) & ~(BLOB_FIELD_ALIGN - 1);
-	return len;
+void blob_field_vector_set(struct blob_field *attr, const void *values, size_t count){
+	size_t n = blob_field_vector_count(attr); 
+	if(count > n) count = n; 
+	// cast to char* is fine since the field itself is writable
+	char *data = (char*)attr + blob_field_header_len(attr) + BLOB_VECTOR_HDR_LEN; 
+	blob_vector_swap(data, values, blob_field_type_size(blob_field_vector_type(attr)), count); 
 }
 
-const struct blob_field *blob_field_first_child(const struct blob_field *self){
-	if(!self) return NULL; 
-	if(blob_field_raw_len(self) <= sizeof(struct blob_field)) return NULL; 
-	return (const struct blob_field*)blob_field_data(self); 
+long long blob_field_vector_get_int(const struct blob_field *attr, size_t idx){
+	if(idx >= blob_field_vector_count(attr)) return 0; 
+	int type = blob_field_vector_type(attr); 
+	size_t size = blob_field_type_size(type); 
+	const char *ptr = blob_field_vector_data(attr) + idx * size; 
+	switch(type){
+		case BLOB_FIELD_INT8: { int8_t v; blob_vector_swap(&v, ptr, size, 1); return v; }
+		case BLOB_FIELD_INT16: { int16_t v; blob_vector_swap(&v, ptr, size, 1); return v; }
+		case BLOB_FIELD_INT32: { int32_t v; blob_vector_swap(&v, ptr, size, 1); return v; }
+		case BLOB_FIELD_INT64: { int64_t v; blob_vector_swap(&v, ptr, size, 1); return v; }
+		case BLOB_FIELD_FLOAT32: 
+		case BLOB_FIELD_FLOAT64: return blob_field_vector_get_real(attr, idx); 
+	}
+	return 0; 
+}
+
+double blob_field_vector_get_real(const struct blob_field *attr, size_t idx){
+	if(idx >= blob_field_vector_count(attr)) return 0; 
+	int type = blob_field_vector_type(attr); 
+	size_t size = blob_field_type_size(type); 
+	const char *ptr = blob_field_vector_data(attr) + idx * size; 
+	switch(type){
+		case BLOB_FIELD_FLOAT32: { float v; blob_vector_swap(&v, ptr, size, 1); return v; }
+		case BLOB_FIELD_FLOAT64: { double v; blob_vector_swap(&v, ptr, size, 1); return v; }
+	}
+	return blob_field_vector_get_int(attr, idx); 
+}
+
+bool blob_field_is_sorted(const struct blob_field *attr){
+	if(!attr) return false; 
+	return !!(be32toh(attr->id_len) & BLOB_FIELD_SORTED); 
 }
 
-const struct blob_field *blob_field_next_child(const struct blob_field *self, const struct blob_field *child){
-	if(!child) return NULL;
-	// cast to void* to supress alignment warning since blob boundaries are always aligned 	
-	const struct blob_field *ret = (const struct blob_field *)(const void*)((const char *) child + blob_field_raw_pad_len(child));
-	// check if we are still within bounds
-	size_t offset = (const char*)ret - (const char*)self; 
-	if(offset >= blob_field_raw_pad_len(self)) return NULL; 
-	return ret; 
+/*
+void blob_field_set_type(struct blob_field *self, int type){
+	assert(self); 
+	int id_len = be32toh(self->id_len); 
+	id_len = (id_len & ~BLOB_FIELD_ID_MASK) | (type << BLOB_FIELD_ID_SHIFT); 	
+	self->id_len = htobe32(id_len);
 }
+*/
 static bool _blob_field_validate(const struct blob_field *attr, const char *signature, const char **nk){
 	const char *k = signature; 
 	//printf("validating %s\n", signature); 
@@ -350,6 +599,9 @@ static bool _blob_field_validate(const struct blob_field *attr, const char *sign
 				break; 
 			case 'i': 
 				switch(blob_field_type(field)){
+					case BLOB_FIELD_NULL: 
+					case BLOB_FIELD_BOOL: 
+					case BLOB_FIELD_IMM: 
 					case BLOB_FIELD_INT8: 
 					case BLOB_FIELD_INT16: 
 					case BLOB_FIELD_INT32: 
@@ -369,7 +621,10 @@ static bool _blob_field_validate(const struct blob_field *attr, const char *sign
 				}
 				break; 
 			case 's': 
-				if(blob_field_type(field) != BLOB_FIELD_STRING) return false; 
+				if(blob_field_type(field) != BLOB_FIELD_STRING && blob_field_type(field) != BLOB_FIELD_KEYREF) return false; 
+				break; 
+			case 'b': 
+				if(blob_field_type(field) != BLOB_FIELD_BINARY) return false; 
 				break; 
 			case 't': 
 				if(blob_field_type(field) != BLOB_FIELD_TABLE) return false; 
@@ -438,3 +693,75 @@ bool blob_field_parse_values(const struct blob_field *attr, struct blob_policy *
 	}
 	return valid; 
 }
+
+struct blob_policy_slot {
+	uint32_t hash; 
+	int index; // position of the policy entry plus one (0 for an empty slot)
+}; 
+
+struct blob_policy_compiled {
+	struct blob_policy *policy; 
+	int size; // number of policy entries
+	uint32_t mask; // number of slots minus one
+	struct blob_policy_slot slots[]; 
+}; 
+
+static uint32_t blob_policy_hash(const char *name){
+	return blob_hash(name, strlen(name)); 
+}
+
+//! returns position of the slot of the policy entry called name or of the empty slot where it goes
+static uint32_t blob_policy_find(const struct blob_policy_compiled *self, const char *name, uint32_t hash){
+	for(uint32_t idx = hash & self->mask;; idx = (idx + 1) & self->mask){
+		const struct blob_policy_slot *slot = &self->slots[idx]; 
+		if(!slot->index) return idx; 
+		if(slot->hash == hash && strcmp(self->policy[slot->index - 1].name, name) == 0) return idx; 
+	}
+}
+
+struct blob_policy_compiled *blob_policy_compile(struct blob_policy *policy, int policy_size){
+	if(!policy || policy_size < 0) return NULL; 
+	// keep at least half of the slots empty so misses end quickly
+	uint32_t size = 8; 
+	while(size < (uint32_t)policy_size * 2) size <<= 1; 
+	struct blob_policy_compiled *self = calloc(1, sizeof(struct blob_policy_compiled) + size * sizeof(struct blob_policy_slot)); 
+	if(!self) return NULL; 
+	self->policy = policy; 
+	self->size = policy_size; 
+	self->mask = size - 1; 
+	for(int c = 0; c < policy_size; c++){
+		uint32_t hash = blob_policy_hash(policy[c].name); 
+		struct blob_policy_slot *slot = &self->slots[blob_policy_find(self, policy[c].name, hash)]; 
+		// like blob_field_parse_values the first entry of a name wins
+		if(slot->index) continue; 
+		slot->hash = hash; 
+		slot->index = c + 1; 
+	}
+	return self; 
+}
+
+void blob_policy_free(struct blob_policy_compiled *compiled){
+	free(compiled); 
+}
+
+bool blob_field_parse_compiled(const struct blob_field *attr, const struct blob_policy_compiled *compiled){
+	if(!attr || !compiled) return false; 
+	// arrays are matched by position so there is nothing to look up
+	if(blob_field_type(attr) != BLOB_FIELD_TABLE) return blob_field_parse_values(attr, compiled->policy, compiled->size); 
+	struct blob_policy *policy = compiled->policy; 
+	bool valid = true; 
+	int processed = 0; 
+	const struct blob_field *key, *value; 
+	blob_field_for_each_kv(attr, key, value){
+		if(processed == compiled->size) return false; 
+		const char *name = blob_field_get_string(key); 
+		const struct blob_policy_slot *slot = &compiled->slots[blob_policy_find(compiled, name, blob_policy_hash(name))]; 
+		if(!slot->index) continue; 
+		struct blob_policy *p = &policy[slot->index - 1]; 
+		if(p->type == BLOB_FIELD_ANY || blob_field_type(value) == p->type) {
+			p->value = value; 
+		} else { p->value = NULL; valid = false; }
+		processed++; 
+	}
+	return valid; 
+}
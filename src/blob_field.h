@@ -19,15 +19,27 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include "ieee754.h"
 
-#define BLOB_FIELD_ID_MASK  0x7f000000
+#define BLOB_FIELD_ID_MASK  0x3f000000
 #define BLOB_FIELD_ID_SHIFT 24
 #define BLOB_FIELD_LEN_MASK 0x00ffffff
 #define BLOB_FIELD_ALIGN    4
-#define BLOB_FIELD_HAS_NAME 0x80000000
+// length of the field does not fit into the header and is stored in a 64 bit word following it
+#define BLOB_FIELD_EXTENDED 0x80000000
+// keys of the table are in ascending order (see blob_close_table_sorted)
+#define BLOB_FIELD_SORTED 0x40000000
+// size of the header of an extended field (header + 64 bit length)
+#define BLOB_FIELD_EXTENDED_HDR_LEN (sizeof(struct blob_field) + sizeof(uint64_t))
+// deepest nesting of arrays and tables that blob_field_check and blob_compact_check accept (same as the json parser)
+#ifndef BLOB_FIELD_MAX_DEPTH
+#define BLOB_FIELD_MAX_DEPTH 1024
+#endif
 
 // a blob attribute header 
+// NOTE: for extended fields data starts after the length word so always use blob_field_data() to get to the payload
 struct blob_field {
 	uint32_t id_len;
 	char data[];
@@ -38,22 +50,16 @@ struct blob_field_policy {
 	uint8_t type;
 };
 
-//! returns the data of the attribute
-const void *blob_field_data(const struct blob_field *attr); 
+// the hot accessors (blob_field_type, blob_field_raw_len, blob_field_data,
+// blob_field_next_child ...) are defined inline in blob.h
 
-//! returns the type of the attribute 
-uint8_t blob_field_type(const struct blob_field *attr); 
 void blob_field_set_type(struct blob_field *self, int type); 
 
-//! returns full length of attribute
-unsigned int blob_field_raw_len(const struct blob_field *attr); 
-void blob_field_set_raw_len(struct blob_field *attr, uint32_t raw_len); 
+//! returns true for tables whose pairs are sorted by key (see blob_close_table_sorted)
+bool blob_field_is_sorted(const struct blob_field *attr); 
 
-//! includes length of data of the attribute
-unsigned int blob_field_data_len(const struct blob_field *attr); 
-
-//! returns padded length of full attribute
-uint32_t blob_field_raw_pad_len(const struct blob_field *attr); 
+//! sets full length of the attribute. Lengths over BLOB_FIELD_LEN_MASK require an extended header. 
+void blob_field_set_raw_len(struct blob_field *attr, size_t raw_len); 
 
 //! get current attribute as an integer
 
@@ -61,7 +67,26 @@ bool blob_field_get_bool(const struct blob_field *self);
 long long int blob_field_get_int(const struct blob_field *self); 
 double blob_field_get_real(const struct blob_field *self); 
 const char *blob_field_get_string(const struct blob_field *self); 
-//size_t blob_field_get_binary(const struct blob_field *attr, uint8_t *data, size_t data_size); 
+//! returns pointer to the data of a binary field and stores its exact length in len (no copy is made)
+const void *blob_field_get_binary(const struct blob_field *attr, size_t *len); 
+
+// size of the header in front of the elements of a vector (element type and three reserved bytes)
+#define BLOB_VECTOR_HDR_LEN 4
+
+//! returns size in bytes of a number of the given type (BLOB_FIELD_INT8 .. BLOB_FIELD_FLOAT64) or 0 for other types
+size_t blob_field_type_size(int type); 
+//! returns type of the elements of a vector field
+int blob_field_vector_type(const struct blob_field *attr); 
+//! returns number of elements in a vector field
+size_t blob_field_vector_count(const struct blob_field *attr); 
+//! returns element idx of a vector as an integer
+long long blob_field_vector_get_int(const struct blob_field *attr, size_t idx); 
+//! returns element idx of a vector as a real
+double blob_field_vector_get_real(const struct blob_field *attr, size_t idx); 
+//! copies up to count elements of a vector into a native array of the element type. Returns number of elements copied. 
+size_t blob_field_vector_copy(const struct blob_field *attr, void *values, size_t count); 
+//! overwrites elements of a vector starting at the first one with count values from a native array of the element type
+void blob_field_vector_set(struct blob_field *attr, const void *values, size_t count); 
 /*
 uint8_t blob_field_get_u8(const struct blob_field *attr); 
 uint8_t blob_field_set_u8(const struct blob_field *attr, uint8_t val); 
@@ -87,10 +112,22 @@ void blob_field_fill_pad(struct blob_field *attr);
 //extern void blob_field_set_raw_len(struct blob_field *attr, unsigned int len);
 bool blob_field_equal(const struct blob_field *a1, const struct blob_field *a2);
 struct blob_field *blob_field_copy(struct blob_field *attr);
-//bool blob_field_check_type(const void *ptr, unsigned int len, int type);
+//! number of bytes blob_field_copy_to writes for attr. This is more than the raw length when attr holds key references to strings in front of it. 
+size_t blob_field_copy_size(const struct blob_field *attr); 
+//! copies attr to out which must have room for blob_field_copy_size bytes. Key references to strings outside of attr are written out as strings so the copy is valid on its own. Returns the number of bytes written. 
+size_t blob_field_copy_to(void *out, const struct blob_field *attr); 
+//! checks that the field and all of its children lie within size bytes and that values have the right length for their type. Arrays and tables nested deeper than BLOB_FIELD_MAX_DEPTH are rejected. Use it before reading untrusted data. 
+bool blob_field_check(const struct blob_field *attr, size_t size);
+//! checks that len bytes of data are a valid value of the given type (arrays and tables are not looked into)
+bool blob_field_check_data(int type, const void *data, size_t len); 
+//! checks only the header of a field: that its length lies within size bytes and that it is not a named field of the old format (see README) 
+bool blob_field_check_header(const struct blob_field *attr, size_t size); 
+
+// number of header bytes that hold the value of an inline field (BLOB_FIELD_NULL, BLOB_FIELD_BOOL, BLOB_FIELD_IMM)
+#define BLOB_FIELD_INLINE_LEN 3
+//! returns value of an inline field from len (0 to 3) big endian bytes. Immediate integers are sign extended. 
+int32_t blob_field_inline_value(int type, const void *data, size_t len);  
 
-const struct blob_field *blob_field_first_child(const struct blob_field *self); 
-const struct blob_field *blob_field_next_child(const struct blob_field *self, const struct blob_field *child); 
 
 void blob_field_dump(const struct blob_field *self); 
 
@@ -101,6 +138,15 @@ bool blob_field_parse(const struct blob_field *attr, const char *signature, cons
 struct blob_policy; 
 bool blob_field_parse_values(const struct blob_field *attr, struct blob_policy *policy, int policy_size); 
 
+//! a policy with a hash of its names (see blob_policy_compile)
+struct blob_policy_compiled; 
+//! Hashes the names of a policy once for blob_field_parse_compiled. The policy is referenced and must outlive the result. Returns NULL if memory could not be allocated. 
+struct blob_policy_compiled *blob_policy_compile(struct blob_policy *policy, int policy_size); 
+//! Frees a compiled policy
+void blob_policy_free(struct blob_policy_compiled *compiled); 
+//! Same as blob_field_parse_values on the policy that was compiled but finds the policy entry of each key of a table with a hash lookup
+bool blob_field_parse_compiled(const struct blob_field *attr, const struct blob_policy_compiled *compiled); 
+
 #define blob_field_for_each_kv(attr, key, value) \
 	for(key = blob_field_first_child(attr), value = blob_field_next_child(attr, key); \
 		key && value; \
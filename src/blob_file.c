@@ -0,0 +1,192 @@
+/*
+ 	Copyright (C) 2015 Martin Schröder <mkschreder.uk@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// for mremap
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "blob_file.h"
+#include "blob_private.h"
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+static void *blob_mapped_alloc(void *ctx, size_t size){
+	return NULL; 
+}
+
+static void *blob_mapped_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size){
+	return NULL; 
+}
+
+static void blob_mapped_free(void *ctx, void *ptr, size_t size){
+	munmap(ptr, size); 
+}
+
+// allocator for mapped files. The mapping can not grow and is released with munmap. 
+static const struct blob_allocator blob_mapped_allocator = {
+	.alloc = blob_mapped_alloc, 
+	.realloc = blob_mapped_realloc, 
+	.free = blob_mapped_free, 
+	.ctx = NULL
+}; 
+
+bool blob_open_mapped(struct blob *buf, const char *path){
+	memset(buf, 0, sizeof(struct blob)); 
+	int fd = open(path, O_RDONLY); 
+	if(fd < 0) return false; 
+	struct stat st; 
+	if(fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(struct blob_field)){
+		close(fd); 
+		return false; 
+	}
+	size_t size = (size_t)st.st_size; 
+	void *mem = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0); 
+	// the mapping stays valid after the descriptor is closed
+	close(fd); 
+	if(mem == MAP_FAILED) return false; 
+	if(!blob_check_head(mem, size)){
+		munmap(mem, size); 
+		return false; 
+	}
+	buf->alloc = &blob_mapped_allocator; 
+	buf->buf = mem; 
+	buf->memlen = size; 
+	buf->flags = BLOB_FLAG_READONLY; 
+	return true; 
+}
+
+struct blob_file {
+	struct blob_allocator alloc; // allocator interface bound to the file
+	int fd; 
+}; 
+
+static void *blob_file_alloc(void *ctx, size_t size){
+	return NULL; 
+}
+
+static void *blob_file_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size){
+	struct blob_file *self = ctx; 
+	if(ftruncate(self->fd, (off_t)new_size) < 0) return NULL; 
+#ifdef MREMAP_MAYMOVE
+	void *mem = mremap(ptr, old_size, new_size, MREMAP_MAYMOVE); 
+#else
+	// written pages are already in the file so the mapping can simply be recreated
+	void *mem = mmap(NULL, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, self->fd, 0); 
+	if(mem != MAP_FAILED) munmap(ptr, old_size); 
+#endif
+	if(mem == MAP_FAILED){
+		// the old mapping is still in use so the file must keep matching it
+		if(ftruncate(self->fd, (off_t)old_size) < 0){
+			// the file keeps the larger size which only wastes space
+		}
+		return NULL; 
+	}
+	return mem; 
+}
+
+static void blob_file_free(void *ctx, void *ptr, size_t size){
+	struct blob_file *self = ctx; 
+	// the file is left with exactly the message (the root element covers all of it)
+	size_t len = blob_field_raw_pad_len(ptr); 
+	munmap(ptr, size); 
+	if(ftruncate(self->fd, (off_t)len) < 0){
+		// nothing we can do here, the file just keeps the unused tail
+	}
+	close(self->fd); 
+	free(self); 
+}
+
+bool blob_create_mapped(struct blob *buf, const char *path){
+	memset(buf, 0, sizeof(struct blob)); 
+	struct blob_file *self = malloc(sizeof(struct blob_file)); 
+	if(!self) return false; 
+	// the blob is built in a new file that replaces path. Truncating an existing file
+	// would pull the pages from under processes that still have it mapped.
+	size_t path_len = strlen(path); 
+	char *tmp = malloc(path_len + sizeof(".XXXXXX")); 
+	if(!tmp) goto fail; 
+	memcpy(tmp, path, path_len); 
+	memcpy(tmp + path_len, ".XXXXXX", sizeof(".XXXXXX")); 
+	self->fd = mkstemp(tmp); 
+	if(self->fd < 0) goto fail_tmp; 
+	// mkstemp creates the file with 0600 but the blob should be readable like any other file
+	mode_t mask = umask(0); 
+	umask(mask); 
+	if(fchmod(self->fd, 0644 & ~mask) < 0) goto fail_close; 
+	if(ftruncate(self->fd, BLOB_GROW_STEP) < 0) goto fail_close; 
+	void *mem = mmap(NULL, BLOB_GROW_STEP, PROT_READ | PROT_WRITE, MAP_SHARED, self->fd, 0); 
+	if(mem == MAP_FAILED) goto fail_close; 
+	if(rename(tmp, path) < 0){
+		munmap(mem, BLOB_GROW_STEP); 
+		goto fail_close; 
+	}
+	free(tmp); 
+	self->alloc.alloc = blob_file_alloc; 
+	self->alloc.realloc = blob_file_realloc; 
+	self->alloc.free = blob_file_free; 
+	self->alloc.ctx = self; 
+	buf->alloc = &self->alloc; 
+	buf->buf = mem; 
+	buf->memlen = BLOB_GROW_STEP; 
+	blob_reset(buf); 
+	return true; 
+fail_close: 
+	close(self->fd); 
+	unlink(tmp); 
+fail_tmp: 
+	free(tmp); 
+fail: 
+	free(self); 
+	return false; 
+}
+
+bool blob_is_mapped(const struct blob *buf){
+	return buf->alloc == &blob_mapped_allocator || (buf->alloc && buf->alloc->free == blob_file_free); 
+}
+
+bool blob_sync(struct blob *buf){
+	if(!buf->buf || buf->alloc->free != blob_file_free) return false; 
+	struct blob_file *self = buf->alloc->ctx; 
+	if(msync(buf->buf, blob_size(buf), MS_SYNC) < 0) return false; 
+	// also makes the new length of the file durable
+	return fsync(self->fd) == 0; 
+}
+#else
+bool blob_open_mapped(struct blob *buf, const char *path){
+	memset(buf, 0, sizeof(struct blob)); 
+	return false; 
+}
+
+bool blob_create_mapped(struct blob *buf, const char *path){
+	memset(buf, 0, sizeof(struct blob)); 
+	return false; 
+}
+
+bool blob_sync(struct blob *buf){
+	return false; 
+}
+
+bool blob_is_mapped(const struct blob *buf){
+	return false; 
+}
+#endif
@@ -0,0 +1,26 @@
+/*
+ 	Copyright (C) 2015 Martin Schröder <mkschreder.uk@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "blob.h"
+
+//! Maps a blob file read only. Pages are shared by all processes that map the same file so nothing is copied at startup. Only the root header is checked against the file size (use blob_field_check before reading untrusted files). The blob is read only and blob_free unmaps the file. 
+bool blob_open_mapped(struct blob *buf, const char *path); 
+//! Creates a file and initializes a blob that is built directly in a shared mapping of it. An existing file at path is replaced with rename() so processes that still map it keep reading the old content. Growing the blob extends the file and the mapping. blob_free trims the file to the size of the message and closes it. 
+bool blob_create_mapped(struct blob *buf, const char *path); 
+//! Flushes a blob created with blob_create_mapped to disk. Returns false for other blobs or if writing failed. 
+bool blob_sync(struct blob *buf); 
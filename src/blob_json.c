@@ -104,8 +104,8 @@ bool blob_put_json_from_string(struct blob *b, const char *str){
 }
 */
 struct strbuf {
-	int len;
-	int pos;
+	size_t len;
+	size_t pos;
 	char *buf;
 
 	blob_json_format_t custom_format;
@@ -114,9 +114,9 @@ struct strbuf {
 	int indent_level;
 };
 
-static bool blob_puts(struct strbuf *s, const char *c, int len)
+static bool blob_puts(struct strbuf *s, const char *c, size_t len)
 {
-	if (len <= 0)
+	if (len == 0)
 		return true;
 
 	if (s->pos + len >= s->len) {
@@ -208,6 +208,89 @@ static void blob_format_string(struct strbuf *s, const char *str)
 
 static void blob_format_json_list(struct strbuf *s, const struct blob_field *attr, bool array);
 
+static void blob_format_json_vector(struct strbuf *s, const struct blob_field *attr){
+	char buf[64]; 
+	int type = blob_field_vector_type(attr); 
+	size_t count = blob_field_vector_count(attr); 
+
+	blob_puts(s, "[", 1); 
+	for(size_t c = 0; c < count; c++){
+		if(c) blob_puts(s, ",", 1); 
+		// same formatting as for single numbers
+		if(type == BLOB_FIELD_FLOAT32) 
+			snprintf(buf, sizeof(buf), "%f", blob_field_vector_get_real(attr, c)); 
+		else if(type == BLOB_FIELD_FLOAT64) 
+			snprintf(buf, sizeof(buf), "%Le", (long double)blob_field_vector_get_real(attr, c)); 
+		else 
+			snprintf(buf, sizeof(buf), "%lld", blob_field_vector_get_int(attr, c)); 
+		blob_puts(s, buf, strlen(buf)); 
+	}
+	blob_puts(s, "]", 1); 
+}
+
+static const char blob_base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"; 
+
+static void blob_format_binary(struct strbuf *s, const struct blob_field *attr){
+	size_t len = 0; 
+	const uint8_t *data = blob_field_get_binary(attr, &len); 
+	char buf[4]; 
+
+	blob_puts(s, "\"", 1); 
+	for(size_t c = 0; c < len; c += 3){
+		uint32_t v = (uint32_t)data[c] << 16; 
+		if(c + 1 < len) v |= (uint32_t)data[c + 1] << 8; 
+		if(c + 2 < len) v |= data[c + 2]; 
+		buf[0] = blob_base64_chars[(v >> 18) & 0x3f]; 
+		buf[1] = blob_base64_chars[(v >> 12) & 0x3f]; 
+		buf[2] = (c + 1 < len)?blob_base64_chars[(v >> 6) & 0x3f]:'='; 
+		buf[3] = (c + 2 < len)?blob_base64_chars[v & 0x3f]:'='; 
+		blob_puts(s, buf, 4); 
+	}
+	blob_puts(s, "\"", 1); 
+}
+
+static int blob_base64_value(char ch){
+	if(ch >= 'A' && ch <= 'Z') return ch - 'A'; 
+	if(ch >= 'a' && ch <= 'z') return ch - 'a' + 26; 
+	if(ch >= '0' && ch <= '9') return ch - '0' + 52; 
+	if(ch == '+') return 62; 
+	if(ch == '/') return 63; 
+	return -1; 
+}
+
+struct blob_field *blob_put_base64(struct blob *buf, const char *str){
+	assert(str); 
+	size_t slen = strlen(str); 
+	size_t pad = 0; 
+
+	// validate first so that nothing is written for bad input
+	if(slen % 4) return NULL; 
+	if(slen && str[slen - 1] == '=') pad++; 
+	if(slen > 1 && str[slen - 2] == '=') pad++; 
+	for(size_t c = 0; c < slen - pad; c++){
+		if(blob_base64_value(str[c]) < 0) return NULL; 
+	}
+	size_t len = slen / 4 * 3 - pad; 
+
+	// reserve the field and decode directly into it
+	struct blob_field *attr = blob_put_binary(buf, NULL, len); 
+	if(!attr || (buf->flags & BLOB_FLAG_MEASURE)) return attr; 
+
+	uint8_t *out = (uint8_t*)attr + blob_field_header_len(attr); 
+	size_t pos = 0; 
+	for(size_t c = 0; c < slen; c += 4){
+		uint32_t v = 0; 
+		for(int j = 0; j < 4; j++){
+			int d = (str[c + j] == '=')?0:blob_base64_value(str[c + j]); 
+			v = (v << 6) | (uint32_t)d; 
+		}
+		if(pos < len) out[pos++] = (uint8_t)(v >> 16); 
+		if(pos < len) out[pos++] = (uint8_t)(v >> 8); 
+		if(pos < len) out[pos++] = (uint8_t)v; 
+	}
+	return attr; 
+}
+
 static void blob_format_element(struct strbuf *s, const struct blob_field *attr, bool array, bool head)
 {
 	const char *data_str;
@@ -254,7 +337,8 @@ static void blob_format_element(struct strbuf *s, const struct blob_field *attr,
 		sprintf(buf, "%Le", unpack754_64(be64toh(*(const uint64_t*)data))); 
 		break; 
 	case BLOB_FIELD_STRING:
-		blob_format_string(s, blob_field_data(attr));
+	case BLOB_FIELD_KEYREF:
+		blob_format_string(s, blob_field_get_string(attr));
 		return;
 	case BLOB_FIELD_ARRAY:
 		blob_format_json_list(s, attr, true);
@@ -262,6 +346,21 @@ static void blob_format_element(struct strbuf *s, const struct blob_field *attr,
 	case BLOB_FIELD_TABLE:
 		blob_format_json_list(s, attr, false);
 		return;
+	case BLOB_FIELD_VECTOR:
+		blob_format_json_vector(s, attr);
+		return;
+	case BLOB_FIELD_BINARY:
+		blob_format_binary(s, attr);
+		return;
+	case BLOB_FIELD_NULL:
+		sprintf(buf, "null");
+		break;
+	case BLOB_FIELD_BOOL:
+		sprintf(buf, "%s", blob_field_get_bool(attr) ? "true" : "false");
+		break;
+	case BLOB_FIELD_IMM:
+		sprintf(buf, "%lld", blob_field_get_int(attr));
+		break;
 	}
 
 out:
@@ -274,7 +373,7 @@ static void blob_format_json_list(struct strbuf *s, const struct blob_field *att
 
 	// just validate first that we really have a table and if not then we just output it as an array. 
 	for(pos = blob_field_first_child(attr); pos; pos = blob_field_next_child(attr, pos)){
-		if(!array && blob_field_type(pos) != BLOB_FIELD_STRING){
+		if(!array && blob_field_type(pos) != BLOB_FIELD_STRING && blob_field_type(pos) != BLOB_FIELD_KEYREF){
 			array = true; 
 			break; 
 		}
@@ -294,7 +393,7 @@ static void blob_format_json_list(struct strbuf *s, const struct blob_field *att
 		}
 		
 		if(!array){
-			blob_format_string(s, blob_field_data(pos)); 
+			blob_format_string(s, blob_field_get_string(pos)); 
 			blob_puts(s, ":", s->indent ? 2 : 1);
 			pos = blob_field_next_child(attr, pos); 
 		}
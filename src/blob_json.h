@@ -42,5 +42,9 @@ static inline char *blob_to_json(const struct blob *self){ return blob_field_to_
 bool blob_init_from_json(struct blob *self, const char *json); 
 
 bool blob_put_json(struct blob *self, const char *json); 
-bool blob_put_json_from_file(struct blob *self, const char *file); 
+//! same as blob_put_json but arrays that only hold integers or only hold reals are packed as vectors
+bool blob_put_json_vectors(struct blob *self, const char *json); 
+bool blob_put_json_from_file(struct blob *self, const char *file);
+//! decodes a base64 string (as written by the json export) into a binary field. Returns NULL if the string is not valid base64. 
+struct blob_field *blob_put_base64(struct blob *self, const char *str);  
 
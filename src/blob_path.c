@@ -0,0 +1,129 @@
+/*
+ 	Copyright (C) 2015 Martin Schröder <mkschreder.uk@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "blob_path.h"
+#include "blob_table.h"
+
+//! parses one step at p into step (keys are copied to *keys). Returns position after the step or NULL on error. 
+static const char *blob_path_parse_step(const char *p, struct blob_path_step *step, char **keys){
+	if(*p == '['){
+		p++; 
+		if(*p == '*'){
+			step->type = BLOB_PATH_ANY; 
+			p++; 
+		} else {
+			if(*p < '0' || *p > '9') return NULL; 
+			size_t index = 0; 
+			for(; *p >= '0' && *p <= '9'; p++){
+				if(index > (SIZE_MAX - 9) / 10) return NULL; 
+				index = index * 10 + (size_t)(*p - '0'); 
+			}
+			step->type = BLOB_PATH_INDEX; 
+			step->index = index; 
+		}
+		return (*p == ']')?p + 1:NULL; 
+	}
+	size_t len = strcspn(p, ".[]"); 
+	if(!len) return NULL; 
+	if(len == 1 && *p == '*'){
+		step->type = BLOB_PATH_ANY; 
+	} else {
+		step->type = BLOB_PATH_KEY; 
+		memcpy(*keys, p, len); 
+		(*keys)[len] = 0; 
+		step->key = *keys; 
+		*keys += len + 1; 
+	}
+	return p + len; 
+}
+
+struct blob_path *blob_path_compile(const char *path){
+	if(!path) return NULL; 
+	// every step starts with '.' or '[' except for the first one
+	size_t count = (*path)?1:0; 
+	for(const char *p = path; *p; p++) if(*p == '.' || (*p == '[' && p != path)) count++; 
+	size_t len = strlen(path); 
+	struct blob_path *self = malloc(sizeof(struct blob_path) + count * sizeof(struct blob_path_step) + len + 1); 
+	if(!self) return NULL; 
+	char *keys = (char*)&self->steps[count]; 
+	self->count = 0; 
+	const char *p = path; 
+	while(*p){
+		if(self->count && *p == '.') p++; 
+		else if(self->count && *p != '['){ p = NULL; break; }
+		p = blob_path_parse_step(p, &self->steps[self->count], &keys); 
+		if(!p) break; 
+		self->count++; 
+	}
+	if(!p){
+		free(self); 
+		return NULL; 
+	}
+	return self; 
+}
+
+void blob_path_free(struct blob_path *path){
+	free(path); 
+}
+
+//! collects matches of steps [step, count) below field. Returns false once no more matches are wanted. 
+static bool blob_path_walk(const struct blob_field *field, const struct blob_path *path, size_t step, const struct blob_field **out, size_t out_size, size_t *found, size_t limit){
+	if(step == path->count){
+		if(*found < out_size) out[*found] = field; 
+		(*found)++; 
+		return *found < limit; 
+	}
+	const struct blob_path_step *s = &path->steps[step]; 
+	int type = blob_field_type(field); 
+	if(type != BLOB_FIELD_ARRAY && type != BLOB_FIELD_TABLE) return true; 
+	switch(s->type){
+		case BLOB_PATH_KEY: {
+			const struct blob_field *value = blob_table_find(field, s->key); 
+			if(value) return blob_path_walk(value, path, step + 1, out, out_size, found, limit); 
+		} break; 
+		case BLOB_PATH_INDEX: 
+		case BLOB_PATH_ANY: {
+			const struct blob_field *child; 
+			size_t idx = 0; 
+			for(child = blob_field_first_child(field); child; child = blob_field_next_child(field, child)){
+				// the values of a table are every second child
+				if(type == BLOB_FIELD_TABLE && !(child = blob_field_next_child(field, child))) break; 
+				if(s->type == BLOB_PATH_ANY || idx == s->index){
+					if(!blob_path_walk(child, path, step + 1, out, out_size, found, limit)) return false; 
+					if(s->type == BLOB_PATH_INDEX) break; 
+				}
+				idx++; 
+			}
+		} break; 
+	}
+	return true; 
+}
+
+const struct blob_field *blob_path_get(const struct blob_field *root, const struct blob_path *path){
+	const struct blob_field *ret = NULL; 
+	size_t found = 0; 
+	if(!root || !path) return NULL; 
+	blob_path_walk(root, path, 0, &ret, 1, &found, 1); 
+	return ret; 
+}
+
+size_t blob_path_get_all(const struct blob_field *root, const struct blob_path *path, const struct blob_field **out, size_t out_size){
+	size_t found = 0; 
+	if(!root || !path) return 0; 
+	blob_path_walk(root, path, 0, out, out_size, &found, SIZE_MAX); 
+	return found; 
+}
@@ -0,0 +1,61 @@
+/*
+ 	Copyright (C) 2015 Martin Schröder <mkschreder.uk@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "blob.h"
+
+/*
+A path addresses a field inside of nested tables and arrays, for example
+"a.b[3].c". The path is parsed once by blob_path_compile() and can then be
+resolved against any number of messages without being parsed again. 
+
+	key     value of key in a table
+	[n]     n-th child of an array (or n-th value of a table)
+	[*], *  every child of an array or every value of a table
+
+Keys end at the next '.' or '['. A path that contains wildcards can match more
+than one field. blob_path_get() returns the first of them and
+blob_path_get_all() returns all of them. 
+*/
+
+enum {
+	BLOB_PATH_KEY, 
+	BLOB_PATH_INDEX, 
+	BLOB_PATH_ANY
+}; 
+
+struct blob_path_step {
+	int type; // BLOB_PATH_*
+	const char *key; // null terminated key (BLOB_PATH_KEY)
+	size_t index; // position of the child (BLOB_PATH_INDEX)
+}; 
+
+struct blob_path {
+	size_t count; // number of steps
+	struct blob_path_step steps[]; // keys are stored after the steps
+}; 
+
+//! Compiles a path. Returns NULL if the path is not valid. The path must be freed with blob_path_free(). 
+struct blob_path *blob_path_compile(const char *path); 
+//! Frees a compiled path
+void blob_path_free(struct blob_path *path); 
+
+//! Returns the first field that the path matches starting at root or NULL if there is none
+const struct blob_field *blob_path_get(const struct blob_field *root, const struct blob_path *path); 
+//! Stores up to out_size fields that the path matches into out (in message order). Returns the number of matches which can be larger than out_size. 
+size_t blob_path_get_all(const struct blob_field *root, const struct blob_path *path, const struct blob_field **out, size_t out_size); 
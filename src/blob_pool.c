@@ -0,0 +1,254 @@
+/*
+ 	Copyright (C) 2015 Martin Schröder <mkschreder.uk@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <pthread.h>
+#include "blob_pool.h"
+
+#define BLOB_POOL_BUCKETS (BLOB_POOL_MAX_SHIFT - BLOB_POOL_MIN_SHIFT + 1)
+#define BLOB_POOL_THREAD_BYTES (4 * 1024 * 1024)
+#define BLOB_POOL_GLOBAL_BYTES (16 * 1024 * 1024)
+
+// free buffers are linked through their first bytes
+struct blob_pool_entry {
+	struct blob_pool_entry *next; 
+}; 
+
+struct blob_pool_cache {
+	struct blob_pool_entry *free[BLOB_POOL_BUCKETS]; 
+	size_t bytes; 
+	bool registered; 
+}; 
+
+static __thread struct blob_pool_cache _thread_cache; 
+
+static struct {
+	struct blob_pool_entry *free[BLOB_POOL_BUCKETS]; 
+	size_t bytes; 
+	pthread_mutex_t lock; 
+	pthread_key_t key; 
+	pthread_once_t once; 
+	size_t thread_bytes; 
+	size_t global_bytes; 
+	bool enabled; // read and written atomically since threads check it without the lock
+	struct blob_pool_stats stats; 
+} _pool = {
+	.lock = PTHREAD_MUTEX_INITIALIZER, 
+	.once = PTHREAD_ONCE_INIT, 
+	.thread_bytes = BLOB_POOL_THREAD_BYTES, 
+	.global_bytes = BLOB_POOL_GLOBAL_BYTES
+}; 
+
+#define blob_pool_count(field, n) __atomic_add_fetch(&_pool.stats.field, (n), __ATOMIC_RELAXED)
+
+static inline bool blob_pool_enabled(void){
+	return __atomic_load_n(&_pool.enabled, __ATOMIC_ACQUIRE); 
+}
+
+//! returns bucket index for a size or -1 if the size is too big to be pooled
+static int blob_pool_bucket(size_t size){
+	int b = 0; 
+	while(((size_t)1 << (b + BLOB_POOL_MIN_SHIFT)) < size){
+		if(++b == BLOB_POOL_BUCKETS) return -1; 
+	}
+	return b; 
+}
+
+static inline size_t blob_pool_capacity(int bucket){
+	return (size_t)1 << (bucket + BLOB_POOL_MIN_SHIFT); 
+}
+
+//! moves buffers of a thread cache to the global list (as long as it has room) and frees the rest
+static void blob_pool_flush(struct blob_pool_cache *cache){
+	pthread_mutex_lock(&_pool.lock); 
+	for(int b = 0; b < BLOB_POOL_BUCKETS; b++){
+		struct blob_pool_entry *e = cache->free[b]; 
+		while(e){
+			struct blob_pool_entry *next = e->next; 
+			if(blob_pool_enabled() && _pool.bytes + blob_pool_capacity(b) <= _pool.global_bytes){
+				e->next = _pool.free[b]; 
+				_pool.free[b] = e; 
+				_pool.bytes += blob_pool_capacity(b); 
+			} else {
+				blob_pool_count(retained_bytes, -blob_pool_capacity(b)); 
+				free(e); 
+			}
+			e = next; 
+		}
+		cache->free[b] = NULL; 
+	}
+	cache->bytes = 0; 
+	pthread_mutex_unlock(&_pool.lock); 
+}
+
+static void blob_pool_thread_exit(void *ptr){
+	blob_pool_flush(ptr); 
+}
+
+static void blob_pool_create_key(void){
+	pthread_key_create(&_pool.key, blob_pool_thread_exit); 
+}
+
+//! frees the buffers the calling thread still caches from before the pool was disabled
+static void blob_pool_drain(void){
+	if(_thread_cache.bytes) blob_pool_flush(&_thread_cache); 
+}
+
+static struct blob_pool_cache *blob_pool_thread_cache(void){
+	struct blob_pool_cache *cache = &_thread_cache; 
+	if(!cache->registered){
+		// the key is only used to get a destructor call when the thread exits
+		pthread_once(&_pool.once, blob_pool_create_key); 
+		pthread_setspecific(_pool.key, cache); 
+		cache->registered = true; 
+	}
+	return cache; 
+}
+
+static void *blob_pool_alloc(void *ctx, size_t size){
+	int b = blob_pool_bucket(size); 
+	if(b < 0){
+		blob_pool_count(misses, 1); 
+		return malloc(size); 
+	}
+
+	// poolable buffers always get the capacity of the whole bucket so that they can be recycled later even if the pool was disabled in between
+	if(!blob_pool_enabled()){
+		blob_pool_drain(); 
+		blob_pool_count(misses, 1); 
+		return malloc(blob_pool_capacity(b)); 
+	}
+
+	struct blob_pool_cache *cache = blob_pool_thread_cache(); 
+	struct blob_pool_entry *e = cache->free[b]; 
+	if(e){
+		cache->free[b] = e->next; 
+		cache->bytes -= blob_pool_capacity(b); 
+		blob_pool_count(retained_bytes, -blob_pool_capacity(b)); 
+		blob_pool_count(hits, 1); 
+		return e; 
+	}
+
+	// peek without the lock so that an empty global list costs nothing
+	if(__atomic_load_n(&_pool.free[b], __ATOMIC_RELAXED)){
+		pthread_mutex_lock(&_pool.lock); 
+		e = _pool.free[b]; 
+		if(e){
+			_pool.free[b] = e->next; 
+			_pool.bytes -= blob_pool_capacity(b); 
+		}
+		pthread_mutex_unlock(&_pool.lock); 
+		if(e){
+			blob_pool_count(retained_bytes, -blob_pool_capacity(b)); 
+			blob_pool_count(global_hits, 1); 
+			return e; 
+		}
+	}
+
+	blob_pool_count(misses, 1); 
+	return malloc(blob_pool_capacity(b)); 
+}
+
+static void blob_pool_release(void *ctx, void *ptr, size_t size){
+	if(!ptr) return; 
+	int b = blob_pool_bucket(size); 
+	if(!blob_pool_enabled()){
+		free(ptr); 
+		blob_pool_drain(); 
+		return; 
+	}
+	if(b < 0){
+		free(ptr); 
+		return; 
+	}
+
+	struct blob_pool_cache *cache = blob_pool_thread_cache(); 
+	struct blob_pool_entry *e = ptr; 
+	size_t cap = blob_pool_capacity(b); 
+
+	if(cache->bytes + cap <= _pool.thread_bytes){
+		e->next = cache->free[b]; 
+		cache->free[b] = e; 
+		cache->bytes += cap; 
+		blob_pool_count(retained_bytes, cap); 
+		return; 
+	}
+
+	pthread_mutex_lock(&_pool.lock); 
+	if(_pool.bytes + cap <= _pool.global_bytes){
+		e->next = _pool.free[b]; 
+		_pool.free[b] = e; 
+		_pool.bytes += cap; 
+		e = NULL; 
+	}
+	pthread_mutex_unlock(&_pool.lock); 
+
+	if(e) free(e); 
+	else blob_pool_count(retained_bytes, cap); 
+}
+
+static void *blob_pool_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size){
+	if(!ptr) return blob_pool_alloc(ctx, new_size); 
+
+	int ob = blob_pool_bucket(old_size); 
+	int nb = blob_pool_bucket(new_size); 
+
+	// buffers outside of the pool can be resized by the c library which may avoid the copy
+	if(ob < 0 && nb < 0) return realloc(ptr, new_size); 
+	// the pooled buffer already has the capacity of its whole bucket
+	if(ob >= 0 && nb >= 0 && nb <= ob) return ptr; 
+
+	void *new = blob_pool_alloc(ctx, new_size); 
+	if(!new) return NULL; 
+	memcpy(new, ptr, (old_size < new_size)?old_size:new_size); 
+	blob_pool_release(ctx, ptr, old_size); 
+	return new; 
+}
+
+const struct blob_allocator blob_pool_allocator = {
+	.alloc = blob_pool_alloc, 
+	.realloc = blob_pool_realloc, 
+	.free = blob_pool_release, 
+	.ctx = NULL
+}; 
+
+void blob_pool_enable(const struct blob_pool_config *config){
+	_pool.thread_bytes = (config && config->thread_bytes)?config->thread_bytes:BLOB_POOL_THREAD_BYTES; 
+	_pool.global_bytes = (config && config->global_bytes)?config->global_bytes:BLOB_POOL_GLOBAL_BYTES; 
+	__atomic_store_n(&_pool.enabled, true, __ATOMIC_RELEASE); 
+	blob_set_default_allocator(&blob_pool_allocator); 
+}
+
+void blob_pool_disable(void){
+	blob_set_default_allocator(NULL); 
+	__atomic_store_n(&_pool.enabled, false, __ATOMIC_RELEASE); 
+	// with the pool disabled flushing frees everything
+	blob_pool_flush(&_thread_cache); 
+	struct blob_pool_cache global; 
+	pthread_mutex_lock(&_pool.lock); 
+	memcpy(global.free, _pool.free, sizeof(global.free)); 
+	memset(_pool.free, 0, sizeof(_pool.free)); 
+	_pool.bytes = 0; 
+	pthread_mutex_unlock(&_pool.lock); 
+	blob_pool_flush(&global); 
+}
+
+void blob_pool_get_stats(struct blob_pool_stats *stats){
+	stats->hits = __atomic_load_n(&_pool.stats.hits, __ATOMIC_RELAXED); 
+	stats->global_hits = __atomic_load_n(&_pool.stats.global_hits, __ATOMIC_RELAXED); 
+	stats->misses = __atomic_load_n(&_pool.stats.misses, __ATOMIC_RELAXED); 
+	stats->retained_bytes = __atomic_load_n(&_pool.stats.retained_bytes, __ATOMIC_RELAXED); 
+}
@@ -0,0 +1,53 @@
+/*
+ 	Copyright (C) 2015 Martin Schröder <mkschreder.uk@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "blob.h"
+
+/*
+Buffer recycling pool. When enabled, blob_init takes buffers from the pool and
+blob_free gives them back instead of returning memory to the c library. Each
+thread keeps its own free lists bucketed by power of two capacity. Buffers that
+do not fit into the thread cache go to a bounded global list that all threads
+share. Buffers larger than the biggest bucket are never pooled. 
+*/
+
+// smallest and largest pooled capacity (as power of two)
+#define BLOB_POOL_MIN_SHIFT 8
+#define BLOB_POOL_MAX_SHIFT 20
+
+struct blob_pool_config {
+	size_t thread_bytes; // max bytes retained by each thread (0 for default)
+	size_t global_bytes; // max bytes retained in the shared overflow list (0 for default)
+}; 
+
+struct blob_pool_stats {
+	unsigned long long hits; // allocations served from the thread cache
+	unsigned long long global_hits; // allocations served from the global list
+	unsigned long long misses; // allocations that went to the c library
+	size_t retained_bytes; // bytes currently held by all caches
+}; 
+
+//! allocator that recycles buffers through the pool
+extern const struct blob_allocator blob_pool_allocator; 
+
+//! Enables the pool and makes it the default allocator of blob_init. Config may be NULL for defaults. Call before starting threads that use blobs. 
+void blob_pool_enable(const struct blob_pool_config *config); 
+//! Restores the c library allocator and releases the global list and the cache of the calling thread. Other threads free their caches the next time they allocate or free through the pool (or when they exit). 
+void blob_pool_disable(void); 
+//! Returns counters that can be used to size the pool
+void blob_pool_get_stats(struct blob_pool_stats *stats); 
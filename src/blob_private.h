@@ -0,0 +1,144 @@
+/*
+ 	Copyright (C) 2015 Martin Schröder <mkschreder.uk@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string.h>
+#include "blob.h"
+#include "ieee754.h"
+
+/*
+Helpers shared by the library sources. Not installed and not part of the API.
+*/
+
+/*
+Scratch memory for temporary work such as sorting a table or packing a
+vector. Small requests are served from a buffer on the stack of the caller
+and larger ones from blob_default_allocator. The allocator of the blob is
+never used: fixed, borrowed and mapped blobs have no memory to give and an
+arena would keep the scratch block behind the buffer.
+*/
+
+//! returns stack if size bytes fit into it, otherwise memory from the default allocator (NULL if there is none)
+static inline void *blob_scratch_alloc(void *stack, size_t stack_size, size_t size){
+	if(size <= stack_size) return stack; 
+	return blob_default_allocator.alloc(blob_default_allocator.ctx, size); 
+}
+
+//! releases memory returned by blob_scratch_alloc for the same stack buffer
+static inline void blob_scratch_free(void *stack, void *mem, size_t size){
+	if(mem && mem != stack) blob_default_allocator.free(blob_default_allocator.ctx, mem, size); 
+}
+
+//! FNV-1a hash of len bytes of key. Every hash table of the library uses it. 
+static inline uint32_t blob_hash(const char *key, size_t len){
+	uint32_t hash = 2166136261u; 
+	for(size_t c = 0; c < len; c++) hash = (hash ^ (uint8_t)key[c]) * 16777619u; 
+	return hash; 
+}
+
+//! returns true for blobs created by blob_open_mapped or blob_create_mapped (see blob_file.c)
+bool blob_is_mapped(const struct blob *buf); 
+
+/*
+Encoders that write complete fields to memory that has already been reserved.
+The blob and the rope share them so both produce the same bytes.
+*/
+
+//! writes the header of a field of len bytes (an extended header if len does not fit into the short one)
+static inline void blob_field_init(struct blob_field *attr, uint32_t id, size_t len){
+	assert(attr); 
+	memset(attr, 0, sizeof(struct blob_field)); 
+	uint32_t id_len = (id << BLOB_FIELD_ID_SHIFT) & BLOB_FIELD_ID_MASK;
+	if(len > BLOB_FIELD_LEN_MASK){
+		attr->id_len = htobe32(id_len | BLOB_FIELD_EXTENDED); 
+		blob_field_set_raw_len(attr, len); 
+		return; 
+	}
+	attr->id_len = htobe32(id_len | len);
+}
+
+//! returns full length of a field with payload bytes of data (including the length word of an extended header)
+static inline size_t blob_attr_raw_len(size_t payload){
+	size_t len = sizeof(struct blob_field) + payload; 
+	if(len > BLOB_FIELD_LEN_MASK) len += sizeof(uint64_t); 
+	return len; 
+}
+
+static inline size_t blob_attr_pad_len(size_t payload){
+	return (blob_attr_raw_len(payload) + BLOB_FIELD_ALIGN - 1) & ~(size_t)(BLOB_FIELD_ALIGN - 1); 
+}
+
+//! writes a complete field at pos and returns its padded length
+static inline size_t blob_write_attr(char *pos, int id, const void *data, size_t len){
+	// cast to void* to ignore alignment warning since pos is always at a field boundary
+	struct blob_field *attr = (struct blob_field*)(void*)pos; 
+	blob_field_init(attr, id, blob_attr_raw_len(len)); 
+	blob_field_fill_pad(attr); 
+	memcpy(pos + blob_field_header_len(attr), data, len); 
+	return blob_attr_pad_len(len); 
+}
+
+//! returns payload length of the smallest integer type that can hold val (0 for a header only field if inline values are allowed)
+static inline size_t blob_int_len(long long val, bool inline_ok){
+	if(inline_ok && val >= BLOB_FIELD_IMM_MIN && val <= BLOB_FIELD_IMM_MAX) return 0; 
+	if(val >= INT8_MIN && val <= INT8_MAX) return sizeof(uint8_t); 
+	if(val >= INT16_MIN && val <= INT16_MAX) return sizeof(uint16_t); 
+	if(val >= INT32_MIN && val <= INT32_MAX) return sizeof(uint32_t); 
+	return sizeof(uint64_t); 
+}
+
+//! writes val as a field of the type blob_int_len picks and returns its padded length
+static inline size_t blob_write_int(char *pos, long long val, bool inline_ok){
+	switch(blob_int_len(val, inline_ok)){
+		case 0: {
+			// cast to void* to ignore alignment warning since pos is always at a field boundary
+			struct blob_field *attr = (struct blob_field*)(void*)pos; 
+			attr->id_len = htobe32(((uint32_t)BLOB_FIELD_IMM << BLOB_FIELD_ID_SHIFT) | ((uint32_t)val & BLOB_FIELD_LEN_MASK)); 
+			return sizeof(struct blob_field); 
+		}
+		case sizeof(uint8_t): {
+			uint8_t v = val; 
+			return blob_write_attr(pos, BLOB_FIELD_INT8, &v, sizeof(v)); 
+		}
+		case sizeof(uint16_t): {
+			uint16_t v = htobe16(val); 
+			return blob_write_attr(pos, BLOB_FIELD_INT16, &v, sizeof(v)); 
+		}
+		case sizeof(uint32_t): {
+			uint32_t v = htobe32(val); 
+			return blob_write_attr(pos, BLOB_FIELD_INT32, &v, sizeof(v)); 
+		}
+	}
+	uint64_t v = htobe64(val); 
+	return blob_write_attr(pos, BLOB_FIELD_INT64, &v, sizeof(v)); 
+}
+
+//! returns payload length of a real (a float if val survives the conversion, otherwise a double)
+static inline size_t blob_real_len(double val){
+	return ((float)val == val)?sizeof(uint32_t):sizeof(uint64_t); 
+}
+
+//! writes val as a field of the type blob_real_len picks and returns its padded length
+static inline size_t blob_write_real(char *pos, double val){
+	if(blob_real_len(val) == sizeof(uint32_t)){
+		uint32_t v = htobe32(pack754_32((float)val)); 
+		return blob_write_attr(pos, BLOB_FIELD_FLOAT32, &v, sizeof(v)); 
+	}
+	uint64_t v = htobe64(pack754_64(val)); 
+	return blob_write_attr(pos, BLOB_FIELD_FLOAT64, &v, sizeof(v)); 
+}
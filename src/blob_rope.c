@@ -0,0 +1,219 @@
+/*
+ 	Copyright (C) 2015 Martin Schröder <mkschreder.uk@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "blob_rope.h"
+#include "blob_private.h"
+
+struct blob_rope_chunk {
+	struct blob_rope_chunk *next; 
+	size_t size; // usable size of data
+	size_t used; // bytes written so far
+	char data[]; 
+}; 
+
+void blob_rope_init(struct blob_rope *self, const struct blob_allocator *alloc, size_t chunk_size){
+	assert(self); 
+	memset(self, 0, sizeof(*self)); 
+	self->alloc = (alloc)?alloc:blob_get_default_allocator(); 
+	self->chunk_size = (chunk_size)?chunk_size:BLOB_ROPE_CHUNK_SIZE; 
+	// chunks must end on a field boundary
+	self->chunk_size = (self->chunk_size + BLOB_FIELD_ALIGN - 1) & ~(size_t)(BLOB_FIELD_ALIGN - 1); 
+}
+
+static void blob_rope_free_chunks(struct blob_rope *self, struct blob_rope_chunk *c){
+	while(c){
+		struct blob_rope_chunk *next = c->next; 
+		self->alloc->free(self->alloc->ctx, c, sizeof(struct blob_rope_chunk) + c->size); 
+		c = next; 
+	}
+}
+
+void blob_rope_reset(struct blob_rope *self){
+	assert(self); 
+	if(self->first){
+		blob_rope_free_chunks(self, self->first->next); 
+		self->first->next = NULL; 
+		self->first->used = 0; 
+	}
+	self->last = self->first; 
+	self->size = 0; 
+	self->depth = 0; 
+}
+
+void blob_rope_free(struct blob_rope *self){
+	assert(self); 
+	blob_rope_free_chunks(self, self->first); 
+	self->first = self->last = NULL; 
+	self->size = 0; 
+	self->depth = 0; 
+}
+
+size_t blob_rope_size(struct blob_rope *self){
+	size_t len = sizeof(struct blob_field) + self->size; 
+	if(len > BLOB_FIELD_LEN_MASK) len += sizeof(uint64_t); 
+	return len; 
+}
+
+//! returns space for pad_len bytes at the end of the message. Starts a new chunk if the current one is full.
+static struct blob_field *blob_rope_alloc(struct blob_rope *self, size_t pad_len){
+	struct blob_rope_chunk *c = self->last; 
+	if(!c || c->size - c->used < pad_len){
+		size_t size = (pad_len > self->chunk_size)?pad_len:self->chunk_size; 
+		struct blob_rope_chunk *n = self->alloc->alloc(self->alloc->ctx, sizeof(struct blob_rope_chunk) + size); 
+		if(!n) return NULL; 
+		n->next = NULL; 
+		n->size = size; 
+		n->used = 0; 
+		if(c) c->next = n; 
+		else self->first = n; 
+		c = n; 
+	}
+	self->last = c; 
+	// cast to void* to ignore alignment warning since chunks only hold aligned fields
+	struct blob_field *f = (struct blob_field*)(void*)(c->data + c->used); 
+	c->used += pad_len; 
+	self->size += pad_len; 
+	return f; 
+}
+
+static struct blob_field *blob_rope_new_attr(struct blob_rope *self, int id, size_t payload){
+	struct blob_field *attr = blob_rope_alloc(self, blob_attr_pad_len(payload)); 
+	if(!attr) return NULL; 
+	blob_field_init(attr, id, blob_attr_raw_len(payload)); 
+	blob_field_fill_pad(attr); 
+	return attr; 
+}
+
+static bool blob_rope_put(struct blob_rope *self, int id, const void *ptr, size_t len){
+	char *pos = (char*)blob_rope_alloc(self, blob_attr_pad_len(len)); 
+	if(!pos) return false; 
+	blob_write_attr(pos, id, ptr, len); 
+	return true; 
+}
+
+static blob_offset_t blob_rope_open(struct blob_rope *self, int id){
+	if(self->depth == BLOB_ROPE_MAX_DEPTH) return 0; 
+	// offsets count the root header like offsets of a regular blob
+	blob_offset_t offset = (blob_offset_t)(sizeof(struct blob_field) + self->size); 
+	struct blob_field *attr = blob_rope_new_attr(self, id, 0); 
+	if(!attr) return 0; 
+	self->open[self->depth].offset = offset; 
+	self->open[self->depth].field = attr; 
+	self->depth++; 
+	return offset; 
+}
+
+static bool blob_rope_close(struct blob_rope *self, blob_offset_t offset){
+	if(!offset || !self->depth || self->open[self->depth - 1].offset != offset) return false; 
+	size_t len = sizeof(struct blob_field) + self->size - (size_t)offset; 
+	// leave the container open so the caller still knows where it is
+	if(len > BLOB_FIELD_LEN_MASK) return false; 
+	self->depth--; 
+	// the header may be in an earlier chunk but it never moves so we can patch it directly
+	blob_field_set_raw_len(self->open[self->depth].field, len); 
+	return true; 
+}
+
+blob_offset_t blob_rope_open_array(struct blob_rope *self){
+	return blob_rope_open(self, BLOB_FIELD_ARRAY); 
+}
+
+bool blob_rope_close_array(struct blob_rope *self, blob_offset_t offset){
+	return blob_rope_close(self, offset); 
+}
+
+blob_offset_t blob_rope_open_table(struct blob_rope *self){
+	return blob_rope_open(self, BLOB_FIELD_TABLE); 
+}
+
+bool blob_rope_close_table(struct blob_rope *self, blob_offset_t offset){
+	return blob_rope_close(self, offset); 
+}
+
+bool blob_rope_put_string(struct blob_rope *self, const char *str){
+	assert(str); 
+	return blob_rope_put(self, BLOB_FIELD_STRING, str, strlen(str) + 1); 
+}
+
+bool blob_rope_put_int(struct blob_rope *self, long long val){
+	// the rope has no BLOB_FLAG_INLINE so integers always get a payload
+	char *pos = (char*)blob_rope_alloc(self, blob_attr_pad_len(blob_int_len(val, false))); 
+	if(!pos) return false; 
+	blob_write_int(pos, val, false); 
+	return true; 
+}
+
+bool blob_rope_put_real(struct blob_rope *self, double val){
+	char *pos = (char*)blob_rope_alloc(self, blob_attr_pad_len(blob_real_len(val))); 
+	if(!pos) return false; 
+	blob_write_real(pos, val); 
+	return true; 
+}
+
+bool blob_rope_put_bool(struct blob_rope *self, bool val){
+	uint8_t v = val; 
+	return blob_rope_put(self, BLOB_FIELD_INT8, &v, sizeof(v)); 
+}
+
+bool blob_rope_put_attr(struct blob_rope *self, const struct blob_field *attr){
+	if(!attr) return false; 
+	struct blob_field *f = blob_rope_alloc(self, blob_field_copy_size(attr)); 
+	if(!f) return false; 
+	blob_field_copy_to(f, attr); 
+	return true; 
+}
+
+//! writes the header of the root element and returns its length
+static size_t blob_rope_head(struct blob_rope *self){
+	struct blob_field *head = (struct blob_field*)(void*)self->head; 
+	size_t len = blob_rope_size(self); 
+	uint32_t id_len = ((uint32_t)BLOB_FIELD_ARRAY << BLOB_FIELD_ID_SHIFT) & BLOB_FIELD_ID_MASK; 
+	head->id_len = htobe32(id_len | ((len > BLOB_FIELD_LEN_MASK)?BLOB_FIELD_EXTENDED:0)); 
+	blob_field_set_raw_len(head, len); 
+	return blob_field_header_len(head); 
+}
+
+int blob_rope_iovec(struct blob_rope *self, struct iovec *iov, int iov_count){
+	int count = 0; 
+	if(count < iov_count){
+		iov[count].iov_base = self->head; 
+		iov[count].iov_len = blob_rope_head(self); 
+	}
+	count++; 
+	for(struct blob_rope_chunk *c = self->first; c; c = c->next){
+		if(!c->used) continue; 
+		if(count < iov_count){
+			iov[count].iov_base = c->data; 
+			iov[count].iov_len = c->used; 
+		}
+		count++; 
+	}
+	return count; 
+}
+
+bool blob_rope_flatten(struct blob_rope *self, struct blob *out){
+	assert(out); 
+	blob_reset(out); 
+	if(!self->size) return true; 
+	if(!blob_resize(out, sizeof(struct blob_field) + self->size)) return false; 
+	char *ptr = (char*)blob_head(out) + blob_field_header_len(blob_head(out)); 
+	for(struct blob_rope_chunk *c = self->first; c; c = c->next){
+		memcpy(ptr, c->data, c->used); 
+		ptr += c->used; 
+	}
+	return true; 
+}
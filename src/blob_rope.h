@@ -0,0 +1,97 @@
+/*
+ 	Copyright (C) 2015 Martin Schröder <mkschreder.uk@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <sys/uio.h>
+#include "blob.h"
+
+// default size of chunks allocated by the rope
+#define BLOB_ROPE_CHUNK_SIZE (4096)
+// maximum number of arrays and tables that can be open at the same time
+#define BLOB_ROPE_MAX_DEPTH (32)
+
+/*
+A rope builds a blob in a chain of separately allocated chunks. Growing the
+message only ever adds a new chunk so bytes that have already been written are
+never moved or copied. A field is never split between two chunks (fields larger
+than the chunk size get a chunk of their own) so the unused tail of a chunk is
+simply left out of the output.
+
+The finished message can be sent with writev/sendmsg using blob_rope_iovec() or
+copied into a regular blob with blob_rope_flatten().
+
+Nested arrays and tables are limited to 16MB each. The message as a whole is not.
+
+The rope only writes strings, integers, reals, bools, arrays and tables. It has
+no equivalent of blob_put_binary, blob_put_null or the vector functions, never
+writes header only values (BLOB_FLAG_INLINE, bools are packed as INT8), does not
+intern keys into KEYREF fields and can not sort tables. Fields of these types can
+still be copied in with blob_rope_put_attr().
+*/
+
+struct blob_rope_chunk; 
+
+struct blob_rope_open {
+	blob_offset_t offset; // offset of the container in the message
+	struct blob_field *field; // header of the container
+}; 
+
+struct blob_rope {
+	const struct blob_allocator *alloc; // allocator used for chunks
+	struct blob_rope_chunk *first; 
+	struct blob_rope_chunk *last; // chunk that is currently written to
+	size_t chunk_size; // size of newly allocated chunks
+	size_t size; // number of bytes written to all chunks
+	uint32_t head[3]; // header of the root element (written when exported)
+	struct blob_rope_open open[BLOB_ROPE_MAX_DEPTH]; // currently open containers
+	uint8_t depth; 
+}; 
+
+//! Initializes an empty rope. Chunk size of 0 means BLOB_ROPE_CHUNK_SIZE. Allocator of NULL means the default allocator.
+void blob_rope_init(struct blob_rope *self, const struct blob_allocator *alloc, size_t chunk_size); 
+//! Clears the content of the rope. Keeps the first chunk for reuse.
+void blob_rope_reset(struct blob_rope *self); 
+//! Frees all memory of the rope
+void blob_rope_free(struct blob_rope *self); 
+
+//! Returns the size of the whole message (including the root header)
+size_t blob_rope_size(struct blob_rope *self); 
+
+//! Opens an array. Returns 0 if it could not be written.
+blob_offset_t blob_rope_open_array(struct blob_rope *self); 
+//! Closes an array. Fails if the array is not the last opened container or is larger than 16MB.
+bool blob_rope_close_array(struct blob_rope *self, blob_offset_t offset); 
+//! Opens a table. Returns 0 if it could not be written.
+blob_offset_t blob_rope_open_table(struct blob_rope *self); 
+//! Closes a table. Fails if the table is not the last opened container or is larger than 16MB.
+bool blob_rope_close_table(struct blob_rope *self, blob_offset_t offset); 
+
+//! Packs a string into the rope (see blob_put_string)
+bool blob_rope_put_string(struct blob_rope *self, const char *str); 
+//! Packs an integer in the smallest type it fits into (see blob_put_int)
+bool blob_rope_put_int(struct blob_rope *self, long long val); 
+//! Packs a real number (see blob_put_real)
+bool blob_rope_put_real(struct blob_rope *self, double val); 
+//! Packs a bool (see blob_put_bool)
+bool blob_rope_put_bool(struct blob_rope *self, bool val); 
+//! Copies an existing field into the rope (see blob_put_attr)
+bool blob_rope_put_attr(struct blob_rope *self, const struct blob_field *attr); 
+
+//! Fills iov with the buffers making up the message (header first). Returns the number of entries needed which may be more than iov_count.
+int blob_rope_iovec(struct blob_rope *self, struct iovec *iov, int iov_count); 
+//! Copies the message into a single contiguous blob replacing its previous content.
+bool blob_rope_flatten(struct blob_rope *self, struct blob *out); 
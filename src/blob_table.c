@@ -0,0 +1,136 @@
+/*
+ 	Copyright (C) 2015 Martin Schröder <mkschreder.uk@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "blob_table.h"
+#include "blob_private.h"
+
+// smallest number of slots of an index
+#define BLOB_TABLE_INDEX_MIN_SLOTS (8)
+
+//! returns true for fields that can be used as a key
+static bool blob_table_is_key(const struct blob_field *key){
+	int type = blob_field_type(key); 
+	return type == BLOB_FIELD_STRING || type == BLOB_FIELD_KEYREF; 
+}
+
+//! returns number of slots needed to index the table (0 if it is not an indexable table)
+static uint32_t blob_table_index_slots(const struct blob_field *table){
+	if(blob_field_type(table) != BLOB_FIELD_TABLE || blob_field_raw_len(table) > UINT32_MAX) return 0; 
+	size_t pairs = 0; 
+	const struct blob_field *key, *value; 
+	blob_field_for_each_kv(table, key, value) pairs++; 
+	// keep the load factor at or below one half
+	uint32_t size = BLOB_TABLE_INDEX_MIN_SLOTS; 
+	while(size < pairs * 2) size <<= 1; 
+	return size; 
+}
+
+size_t blob_table_index_mem_size(const struct blob_field *table){
+	return blob_table_index_slots(table) * sizeof(struct blob_table_slot); 
+}
+
+//! returns the slot that holds key or the empty slot where it would go
+static struct blob_table_slot *blob_table_index_find(const struct blob_table_index *self, const char *key, size_t len, uint32_t hash){
+	uint32_t mask = self->size - 1; 
+	for(uint32_t idx = hash & mask;; idx = (idx + 1) & mask){
+		struct blob_table_slot *slot = &self->slots[idx]; 
+		if(!slot->offset) return slot; 
+		if(slot->hash != hash) continue; 
+		const struct blob_field *k = (const struct blob_field*)(const void*)((const char*)self->table + slot->offset); 
+		const char *name = blob_field_get_string(k); 
+		if(strnlen(name, len + 1) == len && memcmp(name, key, len) == 0) return slot; 
+	}
+}
+
+static void blob_table_index_fill(struct blob_table_index *self, const struct blob_field *table, void *mem, uint32_t size){
+	memset(mem, 0, size * sizeof(struct blob_table_slot)); 
+	self->table = table; 
+	self->slots = mem; 
+	self->size = size; 
+	self->count = 0; 
+	const struct blob_field *key, *value; 
+	blob_field_for_each_kv(table, key, value){
+		if(!blob_table_is_key(key)) continue; 
+		const char *name = blob_field_get_string(key); 
+		size_t len = strlen(name); 
+		uint32_t hash = blob_hash(name, len); 
+		struct blob_table_slot *slot = blob_table_index_find(self, name, len, hash); 
+		if(!slot->offset) self->count++; 
+		slot->hash = hash; 
+		slot->offset = (uint32_t)((const char*)key - (const char*)table); 
+	}
+}
+
+bool blob_table_index_build_mem(const struct blob_field *table, struct blob_table_index *self, void *mem, size_t size){
+	assert(self); 
+	memset(self, 0, sizeof(*self)); 
+	uint32_t slots = blob_table_index_slots(table); 
+	if(!slots || !mem || size < slots * sizeof(struct blob_table_slot)) return false; 
+	blob_table_index_fill(self, table, mem, slots); 
+	return true; 
+}
+
+bool blob_table_index_build_alloc(const struct blob_field *table, struct blob_table_index *self, const struct blob_allocator *alloc){
+	assert(self); 
+	memset(self, 0, sizeof(*self)); 
+	if(!alloc) alloc = blob_get_default_allocator(); 
+	uint32_t slots = blob_table_index_slots(table); 
+	if(!slots) return false; 
+	void *mem = alloc->alloc(alloc->ctx, slots * sizeof(struct blob_table_slot)); 
+	if(!mem) return false; 
+	blob_table_index_fill(self, table, mem, slots); 
+	self->alloc = alloc; 
+	return true; 
+}
+
+bool blob_table_index_build(const struct blob_field *table, struct blob_table_index *self){
+	return blob_table_index_build_alloc(table, self, NULL); 
+}
+
+void blob_table_index_free(struct blob_table_index *self){
+	if(!self) return; 
+	if(self->alloc && self->slots) self->alloc->free(self->alloc->ctx, self->slots, self->size * sizeof(struct blob_table_slot)); 
+	memset(self, 0, sizeof(*self)); 
+}
+
+const struct blob_field *blob_table_index_getn(const struct blob_table_index *self, const char *key, size_t len){
+	if(!self || !self->slots || !key) return NULL; 
+	const struct blob_table_slot *slot = blob_table_index_find(self, key, len, blob_hash(key, len)); 
+	if(!slot->offset) return NULL; 
+	const struct blob_field *k = (const struct blob_field*)(const void*)((const char*)self->table + slot->offset); 
+	return blob_field_next_child(self->table, k); 
+}
+
+const struct blob_field *blob_table_index_get(const struct blob_table_index *self, const char *key){
+	if(!key) return NULL; 
+	return blob_table_index_getn(self, key, strlen(key)); 
+}
+
+const struct blob_field *blob_table_find(const struct blob_field *table, const char *key){
+	if(blob_field_type(table) != BLOB_FIELD_TABLE || !key) return NULL; 
+	bool sorted = blob_field_is_sorted(table); 
+	// the last occurrence of a key wins like with the index and blob_field_parse_values
+	const struct blob_field *k, *v, *found = NULL; 
+	blob_field_for_each_kv(table, k, v){
+		if(!blob_table_is_key(k)) continue; 
+		int r = strcmp(blob_field_get_string(k), key); 
+		if(r == 0) found = v; 
+		// all keys from here on sort after the one we look for (equal keys stay next to each other)
+		else if(sorted && r > 0) break; 
+	}
+	return found; 
+}
@@ -0,0 +1,64 @@
+/*
+ 	Copyright (C) 2015 Martin Schröder <mkschreder.uk@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "blob.h"
+
+/*
+An index over the keys of a table for lookups that do not walk the whole
+table. The index is an open addressing hash table of (hash, offset) pairs
+where offset is the position of the key inside the table, so it is only
+valid as long as the table it was built for does not move or change. 
+
+Memory comes either from an allocator (blob_table_index_build) or from a
+caller supplied buffer of blob_table_index_mem_size() bytes
+(blob_table_index_build_mem). When a key occurs more than once the last
+occurrence wins just like with blob_field_parse_values(). 
+*/
+
+struct blob_table_slot {
+	uint32_t hash; 
+	uint32_t offset; // offset of the key from the start of the table (0 for an empty slot)
+}; 
+
+struct blob_table_index {
+	const struct blob_field *table; 
+	struct blob_table_slot *slots; 
+	uint32_t size; // number of slots (power of two)
+	uint32_t count; // number of distinct keys
+	const struct blob_allocator *alloc; // allocator of slots (NULL if the memory belongs to the caller)
+}; 
+
+//! Returns the number of bytes blob_table_index_build_mem needs for a table (0 if it is not a table)
+size_t blob_table_index_mem_size(const struct blob_field *table); 
+//! Builds an index of the keys of a table using the default allocator. Returns false if table is not a table or memory could not be allocated. 
+bool blob_table_index_build(const struct blob_field *table, struct blob_table_index *self); 
+//! Same as blob_table_index_build but allocates from alloc (NULL for the default allocator)
+bool blob_table_index_build_alloc(const struct blob_field *table, struct blob_table_index *self, const struct blob_allocator *alloc); 
+//! Builds the index inside caller provided memory. Returns false if size is less than blob_table_index_mem_size(table). 
+bool blob_table_index_build_mem(const struct blob_field *table, struct blob_table_index *self, void *mem, size_t size); 
+//! Frees memory allocated by the index (does nothing for caller provided memory)
+void blob_table_index_free(struct blob_table_index *self); 
+
+//! Returns the value of key in the indexed table or NULL if the table has no such key
+const struct blob_field *blob_table_index_get(const struct blob_table_index *self, const char *key); 
+//! Same as blob_table_index_get for a key of len bytes that does not need to be null terminated
+const struct blob_field *blob_table_index_getn(const struct blob_table_index *self, const char *key, size_t len); 
+
+//! Returns the value of key in a table or NULL if there is none (the last one if the key occurs more than once, same as the index). This is a linear scan even for tables closed with blob_close_table_sorted (they are only scanned up to where the key would be), use blob_table_index for fast lookups. 
+const struct blob_field *blob_table_find(const struct blob_field *table, const char *key); 
@@ -57,30 +57,72 @@ static void Object_arrayAddItem(void *prv, JSOBJ obj, JSOBJ value){
 	DEBUG("new array item \n"); 
 }
 
+// scratch memory of the decoder comes from the blob allocator. Allocators that have nothing to 
+// give (fixed or mapped blobs) fall back to the default one so every block remembers its owner. 
+struct blob_ujson_block {
+	const struct blob_allocator *alloc; 
+	char data[]; 
+}; 
+
+static void *Object_Malloc(void *prv, size_t size){
+	DEBUG("alloc %lu bytes\n", size); 
+	const struct blob_allocator *alloc = ((struct blob*)prv)->alloc; 
+	struct blob_ujson_block *block = alloc->alloc(alloc->ctx, sizeof(struct blob_ujson_block) + size); 
+	if(!block){
+		alloc = &blob_default_allocator; 
+		block = alloc->alloc(alloc->ctx, sizeof(struct blob_ujson_block) + size); 
+		if(!block) return NULL; 
+	}
+	block->alloc = alloc; 
+	return block->data; 
+}
+
+static void Object_Free(void *prv, void *ptr, size_t size){
+	DEBUG("free object\n"); 
+	if(!ptr) return; 
+	struct blob_ujson_block *block = (struct blob_ujson_block*)((char*)ptr - sizeof(struct blob_ujson_block)); 
+	block->alloc->free(block->alloc->ctx, block, sizeof(struct blob_ujson_block) + size); 
+}
+
+static void *Object_Realloc(void *prv, void *ptr, size_t old_size, size_t size){
+	DEBUG("Object realloc\n"); 
+	if(!ptr) return Object_Malloc(prv, size); 
+	struct blob_ujson_block *block = (struct blob_ujson_block*)((char*)ptr - sizeof(struct blob_ujson_block)); 
+	const struct blob_allocator *alloc = block->alloc; 
+	struct blob_ujson_block *grown = alloc->realloc(alloc->ctx, block, sizeof(struct blob_ujson_block) + old_size, sizeof(struct blob_ujson_block) + size); 
+	if(grown) return grown->data; 
+	// the old block stays valid when growing fails so it can still move to another allocator
+	char *data = Object_Malloc(prv, size); 
+	if(!data) return NULL; 
+	memcpy(data, ptr, (old_size < size)?old_size:size); 
+	Object_Free(prv, ptr, old_size); 
+	return data; 
+}
+
 static JSOBJ Object_newString(void *prv, char *start, char *end){
-	size_t len = end - start + 1; 
-	char *str = malloc(len); 
-	memset(str, 0, len); 
-	strncpy(str, start, end - start); 
-	DEBUG("new string %s\n", str); 
-	void* ret = blob_put_string(prv, str);  
-	free(str); 
-	return ret; 
+	// the decoder already knows the length so the string is copied without scanning it again
+	DEBUG("new string %.*s\n", (int)(end - start), start); 
+	return blob_put_stringn(prv, start, (size_t)(end - start)); 
+}
+
+static JSOBJ Object_newKey(void *prv, char *start, char *end){
+	DEBUG("new key %.*s\n", (int)(end - start), start); 
+	return blob_put_keyn(prv, start, (size_t)(end - start)); 
 }
 
 static JSOBJ Object_newTrue(void *prv){
 	DEBUG("new true\n"); 
-	return blob_put_int(prv, 1); 
+	return blob_put_bool(prv, true); 
 }
 
 static JSOBJ Object_newFalse(void *prv){
 	DEBUG("new false\n"); 
-	return blob_put_int(prv, 0); 
+	return blob_put_bool(prv, false); 
 }
 
 static JSOBJ Object_newNull(void *prv){
 	DEBUG("new null\n"); 
-	return blob_put_int(prv, 0); 
+	return blob_put_null(prv); 
 }
 
 static JSOBJ Object_newObject(void *prv){	
@@ -119,24 +161,16 @@ static void Object_releaseObject(void *prv, JSOBJ obj){
 	blob_close_table(prv, (blob_offset_t)obj); 
 }
 
-static void *Object_Malloc(size_t size){
-	DEBUG("alloc %lu bytes\n", size); 
-	return malloc(size); 
-}
-
-static void Object_Free(void *ptr){
-	DEBUG("free object\n"); 
-	free(ptr); 
-}
-
-static void *Object_Realloc(void *ptr, size_t size){
-	DEBUG("Object realloc\n"); 
-	return realloc(ptr, size); 
+static void Object_releaseObjectVector(void *prv, JSOBJ obj){
+	DEBUG("close array as vector\n"); 
+	// tables are closed as usual 
+	blob_close_array_vector(prv, (blob_offset_t)obj); 
 }
 
-bool blob_put_json(struct blob *self, const char *json){
+static bool _blob_put_json(struct blob *self, const char *json, bool vectors){
 	JSONObjectDecoder decoder = {
 		.newString = Object_newString,
+		.newKey = Object_newKey,
 		.objectAddKey = Object_objectAddKey,
 		.arrayAddItem = Object_arrayAddItem,
 		.newTrue = Object_newTrue,
@@ -148,7 +182,7 @@ bool blob_put_json(struct blob *self, const char *json){
 		.newLong = Object_newLong,
 		.newUnsignedLong = Object_newUnsignedLong,
 		.newDouble = Object_newDouble,
-		.releaseObject = Object_releaseObject,
+		.releaseObject = (vectors)?Object_releaseObjectVector:Object_releaseObject,
 		.malloc = Object_Malloc,
 		.free = Object_Free,
 		.realloc = Object_Realloc,
@@ -158,16 +192,27 @@ bool blob_put_json(struct blob *self, const char *json){
 		.prv = self
 	};
 
-	JSON_DecodeObject(&decoder, json, strlen(json));
+	JSOBJ ret = JSON_DecodeObject(&decoder, json, strlen(json));
 
 	if (decoder.errorStr){
 		DEBUG("json parsing failed: %s", decoder.errorStr);
 		return false;
 	}
 
+	// the blob ran out of memory 
+	if(!ret) return false; 
+
 	return true;
 }
 
+bool blob_put_json(struct blob *self, const char *json){
+	return _blob_put_json(self, json, false); 
+}
+
+bool blob_put_json_vectors(struct blob *self, const char *json){
+	return _blob_put_json(self, json, true); 
+}
+
 bool blob_init_from_json(struct blob *self, const char *json){
 	struct blob b; 
 	blob_init(&b, 0, 0); 
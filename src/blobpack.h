@@ -21,4 +21,11 @@
 #include "blob.h"
 #include "blob_field.h"
 #include "blob_json.h"
+#include "blob_arena.h"
+#include "blob_pool.h"
+#include "blob_rope.h"
+#include "blob_file.h"
+#include "blob_compact.h"
+#include "blob_table.h"
+#include "blob_path.h"
 
@@ -178,6 +178,12 @@ typedef void *(*JSPFN_MALLOC)(size_t size);
 typedef void (*JSPFN_FREE)(void *pptr);
 typedef void *(*JSPFN_REALLOC)(void *base, size_t size);
 
+/*
+Decoder memory functions also receive the decoder private pointer and the size of the previous block */
+typedef void *(*JSPFN_DEC_MALLOC)(void *prv, size_t size);
+typedef void (*JSPFN_DEC_FREE)(void *prv, void *pptr, size_t size);
+typedef void *(*JSPFN_DEC_REALLOC)(void *prv, void *base, size_t oldSize, size_t size);
+
 
 struct __JSONObjectEncoder;
 
@@ -300,6 +306,8 @@ EXPORTFUNCTION char *JSON_EncodeObject(JSOBJ obj, JSONObjectEncoder *enc, char *
 typedef struct __JSONObjectDecoder
 {
   JSOBJ (*newString)(void *prv, char *start, char *end);
+  /* called instead of newString for the names of object members (optional) */
+  JSOBJ (*newKey)(void *prv, char *start, char *end);
   void (*objectAddKey)(void *prv, JSOBJ obj, JSOBJ name, JSOBJ value);
   void (*arrayAddItem)(void *prv, JSOBJ obj, JSOBJ value);
   JSOBJ (*newTrue)(void *prv);
@@ -312,9 +320,9 @@ typedef struct __JSONObjectDecoder
   JSOBJ (*newUnsignedLong)(void *prv, JSUINT64 value);
   JSOBJ (*newDouble)(void *prv, double value);
   void (*releaseObject)(void *prv, JSOBJ obj);
-  JSPFN_MALLOC malloc;
-  JSPFN_FREE free;
-  JSPFN_REALLOC realloc;
+  JSPFN_DEC_MALLOC malloc;
+  JSPFN_DEC_FREE free;
+  JSPFN_DEC_REALLOC realloc;
   const char *errorStr;
   const char *errorOffset;
   int preciseFloat;
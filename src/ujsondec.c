@@ -61,6 +61,7 @@ struct DecoderState
 	int escHeap;
 	int lastType;
 	JSUINT32 objDepth;
+	int objectKey;
 	void *prv;
 	JSONObjectDecoder *dec;
 };
@@ -444,10 +445,10 @@ static JSOBJ decode_string ( struct DecoderState *ds)
 			{
 				return SetError(ds, -1, "Could not reserve memory block");
 			}
-			escStart = (char *)ds->dec->realloc(ds->escStart, newSize * sizeof(char));
+			escStart = (char *)ds->dec->realloc(ds->prv, ds->escStart, escLen * sizeof(char), newSize * sizeof(char));
 			if (!escStart)
 			{
-				ds->dec->free(ds->escStart);
+				ds->dec->free(ds->prv, ds->escStart, escLen * sizeof(char));
 				return SetError(ds, -1, "Could not reserve memory block");
 			}
 			ds->escStart = escStart;
@@ -459,7 +460,7 @@ static JSOBJ decode_string ( struct DecoderState *ds)
 			{
 				return SetError(ds, -1, "Could not reserve memory block");
 			}
-			ds->escStart = (char *) ds->dec->malloc(newSize * sizeof(char));
+			ds->escStart = (char *) ds->dec->malloc(ds->prv, newSize * sizeof(char));
 			if (!ds->escStart)
 			{
 				return SetError(ds, -1, "Could not reserve memory block");
@@ -487,6 +488,10 @@ static JSOBJ decode_string ( struct DecoderState *ds)
 				ds->lastType = JT_UTF8;
 				inputOffset ++;
 				ds->start += ( (const char *) inputOffset - (ds->start));
+				if (ds->objectKey && ds->dec->newKey)
+				{
+					return ds->dec->newKey(ds->prv, ds->escStart, escOffset);
+				}
 				return ds->dec->newString(ds->prv, ds->escStart, escOffset);
 			}
 			case DS_UTFLENERROR:
@@ -760,7 +765,9 @@ static JSOBJ decode_object( struct DecoderState *ds)
 		}
 
 		ds->lastType = JT_INVALID;
+		ds->objectKey = 1;
 		itemName = decode_any(ds);
+		ds->objectKey = 0;
 
 		if (itemName == NULL)
 		{
@@ -877,6 +884,7 @@ JSOBJ JSON_DecodeObject(JSONObjectDecoder *dec, const char *buffer, size_t cbBuf
 	ds.dec->errorStr = NULL;
 	ds.dec->errorOffset = NULL;
 	ds.objDepth = 0;
+	ds.objectKey = 0;
 
 	ds.dec = dec;
 
@@ -884,7 +892,7 @@ JSOBJ JSON_DecodeObject(JSONObjectDecoder *dec, const char *buffer, size_t cbBuf
 
 	if (ds.escHeap)
 	{
-		dec->free(ds.escStart);
+		dec->free(ds.prv, ds.escStart, (ds.escEnd - ds.escStart) * sizeof(char));
 	}
 
 	if (!(dec->errorStr))
@@ -0,0 +1,85 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+
+struct tracker {
+	int allocs; 
+	int frees; 
+	size_t live; 
+	size_t largest; 
+}; 
+
+static void *track_alloc(void *ctx, size_t size){
+	struct tracker *t = ctx; 
+	t->allocs++; 
+	t->live += size; 
+	return malloc(size); 
+}
+
+static void *track_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size){
+	struct tracker *t = ctx; 
+	t->live += new_size - old_size; 
+	if(new_size > t->largest) t->largest = new_size; 
+	return realloc(ptr, new_size); 
+}
+
+static void track_free(void *ctx, void *ptr, size_t size){
+	struct tracker *t = ctx; 
+	t->frees++; 
+	t->live -= size; 
+	free(ptr); 
+}
+
+int main(void){
+	struct tracker t = {0}; 
+	const struct blob_allocator alloc = {
+		.alloc = track_alloc, 
+		.realloc = track_realloc, 
+		.free = track_free, 
+		.ctx = &t
+	}; 
+	struct blob blob; 
+	blob_init_alloc(&blob, &alloc, 0, 0); 
+
+	TEST(t.allocs == 1); 
+
+	for(int c = 0; c < 1000; c++) blob_put_int(&blob, c); 
+	TEST(t.live == blob.memlen); 
+
+	// strings longer than the decoder stack buffer make the decoder allocate through the blob allocator
+	TEST(blob_put_json(&blob, "{\"key\":\"a string that is longer than sixty four characters so that it must go to heap\\n\"}")); 
+	TEST(t.live == blob.memlen); 
+	TEST(t.allocs > 1); 
+
+	blob_free(&blob); 
+	TEST(t.live == 0); 
+	TEST(t.allocs == t.frees); 
+
+	// sorting a table never takes scratch memory from the blob allocator
+	blob_init_alloc(&blob, &alloc, 0, 0); 
+	blob_offset_t o = blob_open_table(&blob); 
+	blob_put_string(&blob, "b"); 
+	blob_put_int(&blob, 1); 
+	blob_put_string(&blob, "a"); 
+	blob_put_int(&blob, 2); 
+	int allocs = t.allocs; 
+	TEST(blob_close_table_sorted(&blob, o)); 
+	TEST(t.allocs == allocs); 
+	TEST(t.live == blob.memlen); 
+	blob_free(&blob); 
+	TEST(t.live == 0); 
+
+	// geometric growth stops at the size limit
+	blob_init_alloc(&blob, &alloc, 0, 0); 
+	bool ok = true; 
+	for(int c = 0; c < 1200000; c++) ok = ok && blob_put_int(&blob, c) != NULL; 
+	TEST(ok); 
+	TEST(blob_size(&blob) > 9 * 1000 * 1000); 
+	TEST(t.largest <= BLOB_MAX_SIZE); 
+	TEST(blob_put_int(&blob, 1) != NULL); 
+	blob_free(&blob); 
+	TEST(t.live == 0); 
+
+	return 0; 
+}
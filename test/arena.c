@@ -0,0 +1,72 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+
+int main(void){
+	struct blob_arena arena; 
+	blob_arena_init(&arena, 4096); 
+
+	struct blob a, b; 
+	blob_init_arena(&a, &arena, 0, 0); 
+	blob_init_arena(&b, &arena, 0, 0); 
+
+	// b is the last allocation so growing it must not move it
+	void *mem = b.buf; 
+	for(int c = 0; c < 200; c++) blob_put_int(&b, c); 
+	TEST(b.buf == mem); 
+	TEST(b.memlen > 256); 
+
+	// a is not last so it has to be copied but must keep its content
+	blob_put_string(&a, "foo"); 
+	for(int c = 0; c < 200; c++) blob_put_int(&a, c); 
+	TEST(a.buf != mem); 
+	TEST(strcmp(blob_field_get_string(blob_field_first_child(blob_head(&a))), "foo") == 0); 
+
+	// json decoder temporaries are released again so the blob stays last
+	struct blob j; 
+	blob_init_arena(&j, &arena, 0, 0); 
+	mem = j.buf; 
+	TEST(blob_put_json(&j, "{\"one\":1,\"two\":\"a string that is long enough to make the decoder use heap memory for it\"}")); 
+	TEST(j.buf == mem); 
+
+	// blobs bigger than a block get their own block
+	struct blob big; 
+	blob_init_arena(&big, &arena, 0, 0); 
+	for(int c = 0; c < 10000; c++) blob_put_int(&big, c); 
+	TEST(blob_field_get_int(blob_field_first_child(blob_head(&big))) == 0); 
+	TEST(arena.large != NULL); 
+
+	// which leaves the current block alone so its last blob still grows in place
+	struct blob c; 
+	blob_init_arena(&c, &arena, 0, 0); 
+	void *block = arena.block; 
+	mem = c.buf; 
+	for(int i = 0; i < 10000; i++) blob_put_int(&big, i); 
+	for(int i = 0; i < 100; i++) blob_put_int(&c, i); 
+	TEST(c.buf == mem); 
+	TEST(arena.block == block); 
+	blob_free(&c); 
+
+	// freeing the most recent large allocation gives its block back
+	struct blob huge; 
+	void *large = arena.large; 
+	blob_init_arena(&huge, &arena, 0, 8192); 
+	TEST(arena.large != large); 
+	blob_free(&huge); 
+	TEST(arena.large == large); 
+
+	blob_free(&a); 
+	blob_free(&b); 
+	blob_free(&j); 
+	blob_free(&big); 
+
+	blob_arena_reset(&arena); 
+
+	blob_init_arena(&a, &arena, 0, 0); 
+	blob_put_string(&a, "again"); 
+	TEST(strcmp(blob_field_get_string(blob_field_first_child(blob_head(&a))), "again") == 0); 
+
+	blob_arena_free(&arena); 
+	return 0; 
+}
@@ -0,0 +1,45 @@
+#include <blobpack.h>
+#include <stdio.h>
+#include <time.h>
+
+/*
+Packs a large integer array with one blob_put_int call per element and with
+a single blob_put_int_array call. 
+*/
+
+#define COUNT 100000
+
+static double now_msec(void){
+	struct timespec ts; 
+	clock_gettime(CLOCK_MONOTONIC, &ts); 
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0; 
+}
+
+int main(void){
+	static int64_t values[COUNT]; 
+	for(int c = 0; c < COUNT; c++) values[c] = (int64_t)c * 37; 
+	const int rounds = 100; 
+	struct blob b; 
+	blob_init(&b, 0, 0); 
+
+	double start = now_msec(); 
+	for(int r = 0; r < rounds; r++){
+		blob_reset(&b); 
+		blob_offset_t o = blob_open_array(&b); 
+		for(int c = 0; c < COUNT; c++) blob_put_int(&b, values[c]); 
+		blob_close_array(&b, o); 
+	}
+	double single = now_msec() - start; 
+
+	start = now_msec(); 
+	for(int r = 0; r < rounds; r++){
+		blob_reset(&b); 
+		blob_put_int_array(&b, values, COUNT); 
+	}
+	double bulk = now_msec() - start; 
+
+	printf("%d ints (%u bytes): blob_put_int %8.3f ms blob_put_int_array %8.3f ms\n", 
+		COUNT, (unsigned)blob_size(&b), single / rounds, bulk / rounds); 
+	blob_free(&b); 
+	return 0; 
+}
@@ -0,0 +1,98 @@
+#include <blobpack.h>
+#include <stdio.h>
+#include <time.h>
+
+/*
+Compares size and speed of the regular layout with the compact encoding for a
+typical small message. Encoding and decoding convert between the two formats,
+reading walks every field of the message with struct blob_value. 
+*/
+
+#define ROUNDS 200000
+
+static double now_msec(void){
+	struct timespec ts; 
+	clock_gettime(CLOCK_MONOTONIC, &ts); 
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0; 
+}
+
+static void build(struct blob *b){
+	blob_offset_t t = blob_open_table(b); 
+	blob_put_string(b, "id"); 
+	blob_put_int(b, 1234); 
+	blob_put_string(b, "seq"); 
+	blob_put_int(b, 7); 
+	blob_put_string(b, "ok"); 
+	blob_put_bool(b, true); 
+	blob_put_string(b, "temp"); 
+	blob_put_real(b, 21.5); 
+	blob_put_string(b, "name"); 
+	blob_put_string(b, "sensor-1"); 
+	blob_put_string(b, "values"); 
+	blob_offset_t a = blob_open_array(b); 
+	for(int c = 0; c < 8; c++) blob_put_int(b, c * 3); 
+	blob_close_array(b, a); 
+	blob_close_table(b, t); 
+}
+
+static long long walk(const struct blob_value *v){
+	long long sum = v->type; 
+	struct blob_value child; 
+	for(bool ok = blob_value_first_child(v, &child); ok; ok = blob_value_next_child(v, &child)){
+		if(child.type == BLOB_FIELD_ARRAY || child.type == BLOB_FIELD_TABLE) sum += walk(&child); 
+		else sum += blob_value_get_int(&child); 
+	}
+	return sum; 
+}
+
+int main(void){
+	struct blob b, d; 
+	blob_init(&b, 0, 0); 
+	blob_init(&d, 0, 0); 
+	build(&b); 
+	size_t size = blob_compact_size(blob_head(&b)); 
+	uint8_t out[size]; 
+	blob_compact_encode(blob_head(&b), out, size); 
+
+	double start = now_msec(); 
+	for(int r = 0; r < ROUNDS; r++){
+		blob_reset(&b); 
+		build(&b); 
+	}
+	double build_ms = now_msec() - start; 
+
+	start = now_msec(); 
+	for(int r = 0; r < ROUNDS; r++) blob_compact_encode(blob_head(&b), out, size); 
+	double encode_ms = now_msec() - start; 
+
+	start = now_msec(); 
+	for(int r = 0; r < ROUNDS; r++) blob_compact_decode(&d, out, size); 
+	double decode_ms = now_msec() - start; 
+
+	struct blob_value v; 
+	volatile long long sum = 0; 
+	start = now_msec(); 
+	for(int r = 0; r < ROUNDS; r++){
+		blob_value_init(&v, b.buf, blob_size(&b)); 
+		sum += walk(&v); 
+	}
+	double read_regular_ms = now_msec() - start; 
+
+	start = now_msec(); 
+	for(int r = 0; r < ROUNDS; r++){
+		blob_value_init(&v, out, size); 
+		sum += walk(&v); 
+	}
+	double read_compact_ms = now_msec() - start; 
+
+	printf("message size: regular %u bytes compact %u bytes (%.0f%%)\n", 
+		(unsigned)blob_size(&b), (unsigned)size, 100.0 * (double)size / (double)blob_size(&b)); 
+	printf("per message: build %.3f us encode %.3f us decode %.3f us\n", 
+		build_ms * 1000 / ROUNDS, encode_ms * 1000 / ROUNDS, decode_ms * 1000 / ROUNDS); 
+	printf("check and read: regular %.3f us compact %.3f us\n", 
+		read_regular_ms * 1000 / ROUNDS, read_compact_ms * 1000 / ROUNDS); 
+
+	blob_free(&b); 
+	blob_free(&d); 
+	return 0; 
+}
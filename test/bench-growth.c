@@ -0,0 +1,70 @@
+#include <blobpack.h>
+#include <stdio.h>
+#include <time.h>
+
+/*
+Measures how many reallocations and how many bytes of copying it takes to build
+blobs of different sizes with each growth policy. Copied bytes are counted as
+the old size of the memory area each time realloc had to move the buffer. 
+*/
+
+struct stats {
+	unsigned long reallocs; 
+	unsigned long long copied; 
+	double msec; 
+}; 
+
+static double now_msec(void){
+	struct timespec ts; 
+	clock_gettime(CLOCK_MONOTONIC, &ts); 
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0; 
+}
+
+static void build(struct blob *b, size_t target, struct stats *st){
+	static const char str[] = "a string field that we pack many times"; 
+	double start = now_msec(); 
+	size_t memlen = b->memlen; 
+	void *mem = b->buf; 
+	// stop before the next pair of fields would cross the target so that we never exceed BLOB_MAX_SIZE
+	while(blob_size(b) + 64 < target){
+		blob_put_string(b, str); 
+		blob_put_int(b, 1000000); 
+		if(b->memlen != memlen){
+			st->reallocs++; 
+			if(b->buf != mem) st->copied += memlen; 
+			memlen = b->memlen; 
+			mem = b->buf; 
+		}
+	}
+	st->msec = now_msec() - start; 
+}
+
+static void run(const char *name, size_t target, enum blob_growth policy, bool reserve){
+	struct blob b; 
+	struct stats st = {0}; 
+	blob_init(&b, 0, 0); 
+	blob_set_growth(&b, policy, 0); 
+	if(reserve){
+		blob_reserve(&b, target); 
+		st.reallocs++; 
+	}
+	build(&b, target, &st); 
+	printf("%-8s %-10s reallocs: %8lu copied: %14llu bytes time: %10.3f ms\n", name, 
+		(reserve)?"reserve":((policy == BLOB_GROWTH_LINEAR)?"linear":"geometric"), 
+		st.reallocs, st.copied, st.msec); 
+	blob_free(&b); 
+}
+
+int main(void){
+	static const struct { const char *name; size_t size; } sizes[] = {
+		{ "1 KB", 1000 }, 
+		{ "1 MB", 1000000 }, 
+		{ "10 MB", 10000000 }
+	}; 
+	for(unsigned c = 0; c < sizeof(sizes) / sizeof(sizes[0]); c++){
+		run(sizes[c].name, sizes[c].size, BLOB_GROWTH_LINEAR, false); 
+		run(sizes[c].name, sizes[c].size, BLOB_GROWTH_GEOMETRIC, false); 
+		run(sizes[c].name, sizes[c].size, BLOB_GROWTH_GEOMETRIC, true); 
+	}
+	return 0; 
+}
@@ -0,0 +1,54 @@
+#include <blobpack.h>
+#include <stdio.h>
+#include <time.h>
+
+/*
+Walks an array of a million fields with the inline accessors from blob.h and
+through pointers to the exported functions, which is what every step cost
+before the accessors were inlined. 
+*/
+
+#define COUNT 1000000
+
+static double now_msec(void){
+	struct timespec ts; 
+	clock_gettime(CLOCK_MONOTONIC, &ts); 
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0; 
+}
+
+// volatile so that the compiler can not see through the calls
+static const struct blob_field *(*volatile first_child)(const struct blob_field *) = blob_field_first_child; 
+static const struct blob_field *(*volatile next_child)(const struct blob_field *, const struct blob_field *) = blob_field_next_child; 
+static uint8_t (*volatile field_type)(const struct blob_field *) = blob_field_type; 
+static size_t (*volatile data_len)(const struct blob_field *) = blob_field_data_len; 
+
+int main(void){
+	const int rounds = 20; 
+	struct blob b; 
+	blob_init(&b, 0, 0); 
+	blob_offset_t o = blob_open_array(&b); 
+	for(int c = 0; c < COUNT; c++) blob_put_int(&b, c * 37); 
+	blob_close_array(&b, o); 
+	const struct blob_field *arr = blob_field_first_child(blob_head(&b)); 
+	const struct blob_field *child; 
+
+	size_t calls = 0; 
+	double start = now_msec(); 
+	for(int r = 0; r < rounds; r++){
+		for(child = first_child(arr); child; child = next_child(arr, child)) calls += field_type(child) + data_len(child); 
+	}
+	double before = now_msec() - start; 
+
+	size_t inlined = 0; 
+	start = now_msec(); 
+	for(int r = 0; r < rounds; r++){
+		blob_field_for_each_child(arr, child) inlined += blob_field_type(child) + blob_field_data_len(child); 
+	}
+	double after = now_msec() - start; 
+
+	if(calls != inlined) { printf("results differ!\n"); return 1; }
+	printf("%d fields: calls %6.3f ns/element inline %6.3f ns/element\n", 
+		COUNT, before * 1000000.0 / rounds / COUNT, after * 1000000.0 / rounds / COUNT); 
+	blob_free(&b); 
+	return 0; 
+}
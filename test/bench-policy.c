@@ -0,0 +1,67 @@
+#include <blobpack.h>
+#include <stdio.h>
+#include <time.h>
+
+/*
+Parses a table with blob_field_parse_values and with a policy compiled by
+blob_policy_compile for policies of different sizes. The table has one key
+for every policy entry and lists them in reverse order. 
+*/
+
+#define MAX_ENTRIES 100
+
+static double now_msec(void){
+	struct timespec ts; 
+	clock_gettime(CLOCK_MONOTONIC, &ts); 
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0; 
+}
+
+int main(void){
+	static const int sizes[] = { 5, 20, 100 }; 
+	static char names[MAX_ENTRIES][16]; 
+	for(int c = 0; c < MAX_ENTRIES; c++) snprintf(names[c], sizeof(names[c]), "field_%d", c); 
+	const int rounds = 100000; 
+
+	for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++){
+		int n = sizes[s]; 
+		struct blob b; 
+		blob_init(&b, 0, 0); 
+		blob_offset_t t = blob_open_table(&b); 
+		for(int c = n - 1; c >= 0; c--){
+			blob_put_string(&b, names[c]); 
+			blob_put_int(&b, c); 
+		}
+		blob_close_table(&b, t); 
+		const struct blob_field *tbl = blob_field_first_child(blob_head(&b)); 
+
+		struct blob_policy policy[MAX_ENTRIES]; 
+		for(int c = 0; c < n; c++){
+			policy[c].name = names[c]; 
+			policy[c].type = BLOB_FIELD_ANY; 
+			policy[c].value = NULL; 
+		}
+
+		long long sum_plain = 0, sum_compiled = 0; 
+		double start = now_msec(); 
+		for(int r = 0; r < rounds; r++){
+			blob_field_parse_values(tbl, policy, n); 
+			sum_plain += blob_field_get_int(policy[r % n].value); 
+		}
+		double plain = now_msec() - start; 
+
+		struct blob_policy_compiled *pc = blob_policy_compile(policy, n); 
+		start = now_msec(); 
+		for(int r = 0; r < rounds; r++){
+			blob_field_parse_compiled(tbl, pc); 
+			sum_compiled += blob_field_get_int(policy[r % n].value); 
+		}
+		double compiled = now_msec() - start; 
+		blob_policy_free(pc); 
+
+		if(sum_plain != sum_compiled) { printf("results differ!\n"); return 1; }
+		printf("%3d entries: parse_values %9.1f ns parse_compiled %7.1f ns\n", 
+			n, plain * 1000000.0 / rounds, compiled * 1000000.0 / rounds); 
+		blob_free(&b); 
+	}
+	return 0; 
+}
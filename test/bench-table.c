@@ -0,0 +1,87 @@
+#include <blobpack.h>
+#include <stdio.h>
+#include <time.h>
+
+/*
+Looks up every key of a table with thousands of keys by walking the table,
+with blob_table_find on the table sorted at close time and through a
+blob_table_index. 
+*/
+
+#define KEYS 5000
+
+static double now_msec(void){
+	struct timespec ts; 
+	clock_gettime(CLOCK_MONOTONIC, &ts); 
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0; 
+}
+
+static const struct blob_field *table_walk(const struct blob_field *table, const char *name){
+	const struct blob_field *key, *value; 
+	blob_field_for_each_kv(table, key, value){
+		if(strcmp(blob_field_get_string(key), name) == 0) return value; 
+	}
+	return NULL; 
+}
+
+int main(void){
+	static char names[KEYS][16]; 
+	struct blob b; 
+	blob_init(&b, 0, 0); 
+	blob_offset_t t = blob_open_table(&b); 
+	for(int c = 0; c < KEYS; c++){
+		snprintf(names[c], sizeof(names[c]), "option.%d", c); 
+		blob_put_string(&b, names[c]); 
+		blob_put_int(&b, c); 
+	}
+	blob_close_table(&b, t); 
+	const struct blob_field *tbl = blob_field_first_child(blob_head(&b)); 
+
+	struct blob s; 
+	blob_init(&s, 0, 0); 
+	t = blob_open_table(&s); 
+	for(int c = 0; c < KEYS; c++){
+		blob_put_string(&s, names[c]); 
+		blob_put_int(&s, c); 
+	}
+	blob_close_table_sorted(&s, t); 
+	const struct blob_field *sorted = blob_field_first_child(blob_head(&s)); 
+
+	long long sum_walk = 0, sum_sorted = 0, sum_index = 0; 
+	double start = now_msec(); 
+	for(int c = 0; c < KEYS; c++) sum_walk += blob_field_get_int(table_walk(tbl, names[c])); 
+	double walk = now_msec() - start; 
+
+	start = now_msec(); 
+	for(int c = 0; c < KEYS; c++) sum_sorted += blob_field_get_int(blob_table_find(sorted, names[c])); 
+	double sorted_find = now_msec() - start; 
+	for(int c = 0; c < KEYS; c++) blob_table_find(sorted, "option.2500a"); 
+	double sorted_miss = now_msec() - start - sorted_find; 
+	start = now_msec(); 
+	for(int c = 0; c < KEYS; c++) blob_table_find(tbl, "option.2500a"); 
+	double walk_miss = now_msec() - start; 
+
+	const int rounds = 100; 
+	struct blob_table_index idx; 
+	start = now_msec(); 
+	for(int r = 0; r < rounds; r++){
+		blob_table_index_build(tbl, &idx); 
+		if(r < rounds - 1) blob_table_index_free(&idx); 
+	}
+	double build = now_msec() - start; 
+	start = now_msec(); 
+	for(int r = 0; r < rounds; r++){
+		sum_index = 0; 
+		for(int c = 0; c < KEYS; c++) sum_index += blob_field_get_int(blob_table_index_get(&idx, names[c])); 
+	}
+	double index = now_msec() - start; 
+	blob_table_index_free(&idx); 
+
+	if(sum_walk != sum_index || sum_walk != sum_sorted) { printf("results differ!\n"); return 1; }
+	printf("%d keys: walk %8.1f ns/lookup (miss %8.1f) sorted %8.1f ns/lookup (miss %8.1f) index %6.1f ns/lookup (build %6.1f us)\n", 
+		KEYS, walk * 1000000.0 / KEYS, walk_miss * 1000000.0 / KEYS, sorted_find * 1000000.0 / KEYS, sorted_miss * 1000000.0 / KEYS, 
+		index * 1000000.0 / rounds / KEYS, build * 1000.0 / rounds); 
+	blob_free(&s); 
+	blob_free(&b); 
+	return 0; 
+}
@@ -0,0 +1,86 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+
+int main(void){
+	struct blob b; 
+	uint8_t data[256]; 
+	for(int c = 0; c < 256; c++) data[c] = (uint8_t)(255 - c); 
+
+	// every length keeps its exact size even though fields are padded
+	blob_init(&b, 0, 0); 
+	for(size_t c = 0; c < 8; c++){
+		TEST(blob_put_binary(&b, data, c) != NULL); 
+	}
+	TEST(blob_field_check(blob_head(&b), blob_size(&b))); 
+	size_t expect = 0; 
+	const struct blob_field *child; 
+	blob_field_for_each_child(blob_head(&b), child){
+		size_t len = 99; 
+		const void *ptr = blob_field_get_binary(child, &len); 
+		TEST(blob_field_type(child) == BLOB_FIELD_BINARY); 
+		TEST(len == expect); 
+		TEST(ptr == blob_field_data(child)); 
+		TEST(memcmp(ptr, data, len) == 0); 
+		TEST(blob_field_raw_pad_len(child) % 4 == 0); 
+		expect++; 
+	}
+	TEST(expect == 8); 
+	TEST(blob_field_validate(blob_head(&b), "bbbbbbbb")); 
+	TEST(!blob_field_validate(blob_head(&b), "s")); 
+
+	// reserving space and filling it in place
+	blob_reset(&b); 
+	struct blob_field *f = blob_put_binary(&b, NULL, sizeof(data)); 
+	TEST(f != NULL); 
+	memcpy((char*)f + blob_field_header_len(f), data, sizeof(data)); 
+	size_t len = 0; 
+	TEST(memcmp(blob_field_get_binary(blob_field_first_child(blob_head(&b)), &len), data, sizeof(data)) == 0); 
+	TEST(len == sizeof(data)); 
+
+	// json export uses base64
+	blob_reset(&b); 
+	blob_put_binary(&b, "f", 1); 
+	blob_put_binary(&b, "fo", 2); 
+	blob_put_binary(&b, "foo", 3); 
+	blob_put_binary(&b, "foob", 4); 
+	blob_put_binary(&b, "", 0); 
+	char *json = blob_to_json(&b); 
+	TEST(json != NULL); 
+	printf("%s\n", json); 
+	TEST(strcmp(json, "[\"Zg==\",\"Zm8=\",\"Zm9v\",\"Zm9vYg==\",\"\"]") == 0); 
+	free(json); 
+
+	// and base64 decodes back into the same bytes
+	struct blob c; 
+	blob_init(&c, 0, 0); 
+	TEST(blob_put_base64(&c, "Zg==") != NULL); 
+	TEST(blob_put_base64(&c, "Zm8=") != NULL); 
+	TEST(blob_put_base64(&c, "Zm9v") != NULL); 
+	TEST(blob_put_base64(&c, "Zm9vYg==") != NULL); 
+	TEST(blob_put_base64(&c, "") != NULL); 
+	TEST(blob_size(&c) == blob_size(&b)); 
+	TEST(memcmp(c.buf, b.buf, blob_size(&b)) == 0); 
+
+	// invalid input is rejected without writing anything
+	size_t size = blob_size(&c); 
+	TEST(blob_put_base64(&c, "Zg=") == NULL); 
+	TEST(blob_put_base64(&c, "Z===") == NULL); 
+	TEST(blob_put_base64(&c, "Zg=a") == NULL); 
+	TEST(blob_put_base64(&c, "Zm9v!A==") == NULL); 
+	TEST(blob_size(&c) == size); 
+
+	// measuring gives the same size as writing
+	struct blob m; 
+	blob_init_measure(&m); 
+	TEST(blob_put_base64(&m, "Zm9vYg==") != NULL); 
+	blob_reset(&c); 
+	TEST(blob_put_base64(&c, "Zm9vYg==") != NULL); 
+	TEST(blob_measured_size(&m) == blob_size(&c)); 
+	blob_free(&m); 
+
+	blob_free(&c); 
+	blob_free(&b); 
+	return 0; 
+}
@@ -0,0 +1,70 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+
+int main(void){
+	struct blob src, view; 
+	blob_init(&src, 0, 0); 
+	blob_offset_t t = blob_open_table(&src); 
+	blob_put_string(&src, "id"); 
+	blob_put_int(&src, 1234); 
+	blob_put_string(&src, "value"); 
+	blob_put_real(&src, 0.5); 
+	blob_close_table(&src, t); 
+	blob_put_string(&src, "hello"); 
+
+	// simulates a socket buffer that the message was received into
+	uint32_t mem[64]; 
+	size_t size = blob_size(&src); 
+	memcpy(mem, src.buf, size); 
+
+	TEST(blob_init_borrowed(&view, mem, size)); 
+	TEST(view.buf == (void*)mem); 
+	TEST(blob_size(&view) == size); 
+
+	const struct blob_field *tbl = blob_field_first_child(blob_head(&view)); 
+	TEST(blob_field_type(tbl) == BLOB_FIELD_TABLE); 
+	const struct blob_field *key, *value; 
+	int count = 0; 
+	blob_field_for_each_kv(tbl, key, value){
+		if(strcmp(blob_field_get_string(key), "id") == 0) { TEST(blob_field_get_int(value) == 1234); }
+		if(strcmp(blob_field_get_string(key), "value") == 0) { TEST(blob_field_get_real(value) == 0.5); }
+		count++; 
+	}
+	TEST(count == 2); 
+	TEST(strcmp(blob_field_get_string(blob_field_next_child(blob_head(&view), tbl)), "hello") == 0); 
+	TEST(blob_field_validate(blob_head(&view), "ts")); 
+
+	// the view never modifies the borrowed memory
+	TEST(blob_put_int(&view, 1) == NULL); 
+	TEST(blob_open_array(&view) == 0); 
+	blob_reset(&view); 
+	blob_close_table(&view, (blob_offset_t)4); 
+	TEST(memcmp(mem, src.buf, size) == 0); 
+	blob_free(&view); 
+	TEST(memcmp(mem, src.buf, size) == 0); 
+
+	// data that does not fit into the supplied length is rejected
+	TEST(!blob_init_borrowed(&view, mem, size - 4)); 
+	TEST(!blob_init_borrowed(&view, mem, 2)); 
+	TEST(!blob_init_borrowed(&view, NULL, size)); 
+	TEST(!blob_init_borrowed(&view, (char*)mem + 1, size)); 
+
+	// as is a child that claims to be longer than its parent
+	struct blob_field *inner = (struct blob_field*)(void*)((char*)mem + ((const char*)tbl - (const char*)mem)); 
+	uint32_t saved = inner->id_len; 
+	blob_field_set_raw_len(inner, blob_field_raw_len(inner) + 64); 
+	TEST(!blob_init_borrowed(&view, mem, size)); 
+	inner->id_len = saved; 
+	TEST(blob_init_borrowed(&view, mem, size)); 
+
+	// and a string that is not terminated
+	char *last = (char*)mem + size - 4; // "hello" is followed by the terminator and two bytes of padding
+	TEST(*last == 'o'); 
+	last[1] = 'x'; 
+	TEST(!blob_init_borrowed(&view, mem, size)); 
+
+	blob_free(&src); 
+	return 0; 
+}
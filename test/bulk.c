@@ -0,0 +1,75 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+
+#define COUNT 1000
+
+static bool same(struct blob *a, struct blob *b){
+	return blob_size(a) == blob_size(b) && memcmp(a->buf, b->buf, blob_size(a)) == 0; 
+}
+
+int main(void){
+	struct blob one, bulk, m; 
+	blob_init(&one, 0, 0); 
+	blob_init(&bulk, 0, 0); 
+
+	// values in all integer ranges
+	int64_t ints[COUNT]; 
+	for(int c = 0; c < COUNT; c++){
+		int64_t v = (int64_t)c * c * c * c * c * c; 
+		ints[c] = (c & 1)?-v:v; 
+	}
+	blob_offset_t o = blob_open_array(&one); 
+	for(int c = 0; c < COUNT; c++) blob_put_int(&one, ints[c]); 
+	blob_close_array(&one, o); 
+	TEST(blob_put_int_array(&bulk, ints, COUNT) != NULL); 
+	TEST(same(&one, &bulk)); 
+
+	// floats and doubles
+	double reals[COUNT]; 
+	for(int c = 0; c < COUNT; c++) reals[c] = (c & 1)?c * 0.5:c * 0.1; 
+	o = blob_open_array(&one); 
+	for(int c = 0; c < COUNT; c++) blob_put_real(&one, reals[c]); 
+	blob_close_array(&one, o); 
+	TEST(blob_put_real_array(&bulk, reals, COUNT) != NULL); 
+	TEST(same(&one, &bulk)); 
+
+	// strings of all lengths modulo the alignment
+	const char *strings[] = { "", "a", "ab", "abc", "abcd", "abcde", "some longer string" }; 
+	o = blob_open_array(&one); 
+	for(unsigned c = 0; c < sizeof(strings) / sizeof(strings[0]); c++) blob_put_string(&one, strings[c]); 
+	blob_close_array(&one, o); 
+	const struct blob_field *arr = blob_put_string_array(&bulk, strings, sizeof(strings) / sizeof(strings[0])); 
+	TEST(arr != NULL); 
+	TEST(blob_field_type(arr) == BLOB_FIELD_ARRAY); 
+	TEST(same(&one, &bulk)); 
+
+	// empty arrays
+	o = blob_open_array(&one); 
+	blob_close_array(&one, o); 
+	TEST(blob_put_int_array(&bulk, NULL, 0) != NULL); 
+	TEST(same(&one, &bulk)); 
+
+	TEST(blob_field_validate(blob_head(&bulk), "aaaa")); 
+
+	// measure mode gives the same size
+	blob_init_measure(&m); 
+	blob_put_int_array(&m, ints, COUNT); 
+	blob_put_real_array(&m, reals, COUNT); 
+	blob_put_string_array(&m, strings, sizeof(strings) / sizeof(strings[0])); 
+	blob_put_int_array(&m, NULL, 0); 
+	TEST(blob_measured_size(&m) == blob_size(&bulk)); 
+
+	// a failed bulk put leaves the blob untouched
+	struct blob fixed; 
+	char mem[64]; 
+	TEST(blob_init_fixed(&fixed, mem, sizeof(mem))); 
+	TEST(blob_put_int_array(&fixed, ints, COUNT) == NULL); 
+	TEST(blob_size(&fixed) == sizeof(struct blob_field)); 
+
+	blob_free(&m); 
+	blob_free(&one); 
+	blob_free(&bulk); 
+	return 0; 
+}
@@ -0,0 +1,144 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+
+static void build(struct blob *b){
+	blob_offset_t t = blob_open_table(b); 
+	blob_put_string(b, "id"); 
+	blob_put_int(b, 12); 
+	blob_put_string(b, "neg"); 
+	blob_put_int(b, -100000); 
+	blob_put_string(b, "big"); 
+	blob_put_int(b, 1LL << 40); 
+	blob_put_string(b, "real"); 
+	blob_put_real(b, 0.25); 
+	blob_put_string(b, "name"); 
+	blob_put_string(b, "a name that is longer than eleven characters"); 
+	blob_put_string(b, "list"); 
+	blob_offset_t a = blob_open_array(b); 
+	for(int c = 0; c < 300; c++) blob_put_int(b, c); 
+	blob_close_array(b, a); 
+	blob_put_string(b, "empty"); 
+	a = blob_open_array(b); 
+	blob_close_array(b, a); 
+	blob_close_table(b, t); 
+	blob_put_binary(b, "\x01\x02\x03", 3); 
+	int16_t v[3] = { -1, 2, 300 }; 
+	blob_put_vector(b, BLOB_FIELD_INT16, v, 3); 
+	// the compact length of this array needs a shorter header than the regular one
+	blob_offset_t s = blob_open_array(b); 
+	for(int c = 0; c < 3; c++) blob_put_int(b, c); 
+	blob_close_array(b, s); 
+}
+
+int main(void){
+	struct blob b, d; 
+	blob_init(&b, 0, 0); 
+	blob_init(&d, 0, 0); 
+	build(&b); 
+
+	size_t size = blob_compact_size(blob_head(&b)); 
+	printf("regular %u bytes, compact %u bytes\n", (unsigned)blob_size(&b), (unsigned)size); 
+	TEST(size < blob_size(&b) / 2); 
+	uint8_t out[size]; 
+	TEST(blob_compact_encode(blob_head(&b), out, size - 1) == 0); 
+	TEST(blob_compact_encode(blob_head(&b), out, size) == size); 
+	TEST(blob_is_compact(out, size)); 
+	TEST(!blob_is_compact(b.buf, blob_size(&b))); 
+	TEST(blob_compact_check(out, size)); 
+
+	// decoding gives back exactly the same blob
+	TEST(blob_compact_decode(&d, out, size)); 
+	TEST(blob_size(&d) == blob_size(&b)); 
+	TEST(memcmp(d.buf, b.buf, blob_size(&b)) == 0); 
+
+	// the same reader works on both formats
+	struct blob_value roots[2]; 
+	TEST(blob_value_init(&roots[0], b.buf, blob_size(&b))); 
+	TEST(blob_value_init(&roots[1], out, size)); 
+	TEST(!roots[0].compact && roots[1].compact); 
+	for(int r = 0; r < 2; r++){
+		struct blob_value tbl, key, val; 
+		TEST(blob_value_first_child(&roots[r], &tbl)); 
+		TEST(blob_value_type(&tbl) == BLOB_FIELD_TABLE); 
+		TEST(blob_value_first_child(&tbl, &key) && strcmp(blob_value_get_string(&key), "id") == 0); 
+		val = key; 
+		TEST(blob_value_next_child(&tbl, &val) && blob_value_get_int(&val) == 12); 
+		key = val; 
+		TEST(blob_value_next_child(&tbl, &key)); 
+		val = key; 
+		TEST(blob_value_next_child(&tbl, &val) && blob_value_get_int(&val) == -100000); 
+		TEST(blob_value_next_child(&tbl, &key) && blob_value_next_child(&tbl, &key)); 
+		val = key; 
+		TEST(blob_value_next_child(&tbl, &val) && blob_value_get_int(&val) == (1LL << 40)); 
+		TEST(blob_value_next_child(&tbl, &key) && blob_value_next_child(&tbl, &key)); 
+		val = key; 
+		TEST(blob_value_next_child(&tbl, &val) && blob_value_get_real(&val) == 0.25); 
+		TEST(blob_value_next_child(&tbl, &key) && blob_value_next_child(&tbl, &key)); 
+		val = key; 
+		TEST(blob_value_next_child(&tbl, &val) && strcmp(blob_value_get_string(&val), "a name that is longer than eleven characters") == 0); 
+		TEST(blob_value_next_child(&tbl, &key) && blob_value_next_child(&tbl, &key)); 
+		val = key; 
+		TEST(blob_value_next_child(&tbl, &val) && blob_value_type(&val) == BLOB_FIELD_ARRAY); 
+		struct blob_value item; 
+		long long sum = 0; 
+		int count = 0; 
+		for(bool ok = blob_value_first_child(&val, &item); ok; ok = blob_value_next_child(&val, &item)){
+			sum += blob_value_get_int(&item); 
+			count++; 
+		}
+		TEST(count == 300 && sum == 299 * 300 / 2); 
+		TEST(blob_value_next_child(&tbl, &val) && blob_value_next_child(&tbl, &val)); 
+		TEST(!blob_value_first_child(&val, &item)); 
+		TEST(!blob_value_next_child(&tbl, &val)); 
+
+		struct blob_value bin = tbl; 
+		TEST(blob_value_next_child(&roots[r], &bin)); 
+		size_t len = 0; 
+		TEST(memcmp(blob_value_get_binary(&bin, &len), "\x01\x02\x03", 3) == 0 && len == 3); 
+		TEST(blob_value_next_child(&roots[r], &bin) && blob_value_type(&bin) == BLOB_FIELD_VECTOR); 
+		TEST(blob_value_next_child(&roots[r], &bin) && bin.len == ((r)?6:24)); 
+		TEST(!blob_value_next_child(&roots[r], &bin)); 
+	}
+
+	// malformed compact data is rejected
+	TEST(!blob_compact_check(out, size - 1)); 
+	TEST(!blob_compact_decode(&d, out, size - 1)); 
+	TEST(!blob_value_init(&roots[1], out, 1)); 
+	uint8_t bad[] = { BLOB_COMPACT_MAGIC_0, BLOB_COMPACT_MAGIC_1, (BLOB_FIELD_ARRAY << 4) | 2, (BLOB_FIELD_INT16 << 4) | 1, 0 }; 
+	TEST(!blob_compact_check(bad, sizeof(bad))); 
+	bad[3] = (BLOB_FIELD_STRING << 4) | 1; 
+	bad[4] = 'x'; // not terminated
+	TEST(!blob_compact_check(bad, sizeof(bad))); 
+	bad[4] = 0; 
+	bad[3] = (BLOB_FIELD_INT8 << 4) | 1; 
+	TEST(blob_compact_check(bad, sizeof(bad))); 
+	bad[2] = (BLOB_FIELD_ARRAY << 4) | 3; 
+	TEST(!blob_compact_check(bad, sizeof(bad))); 
+
+	// an empty blob
+	blob_reset(&b); 
+	size = blob_compact_encode(blob_head(&b), out, sizeof(out)); 
+	TEST(size == 3); 
+	TEST(blob_compact_decode(&d, out, size)); 
+	TEST(blob_size(&d) == sizeof(struct blob_field)); 
+
+	// nesting is limited so that checking can not exhaust the stack
+	for(int depth = BLOB_FIELD_MAX_DEPTH - 1; depth <= BLOB_FIELD_MAX_DEPTH; depth++){
+		blob_offset_t open[BLOB_FIELD_MAX_DEPTH]; 
+		blob_reset(&b); 
+		for(int c = 0; c < depth; c++) open[c] = blob_open_array(&b); 
+		for(int c = depth - 1; c >= 0; c--) blob_close_array(&b, open[c]); 
+		bool ok = depth < BLOB_FIELD_MAX_DEPTH; 
+		TEST(blob_field_check(blob_head(&b), blob_size(&b)) == ok); 
+		size_t len = blob_compact_size(blob_head(&b)); 
+		uint8_t nested[len]; 
+		TEST(blob_compact_encode(blob_head(&b), nested, len) == len); 
+		TEST(blob_compact_check(nested, len) == ok); 
+	}
+
+	blob_free(&b); 
+	blob_free(&d); 
+	return 0; 
+}
@@ -0,0 +1,82 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+#include <stdio.h>
+
+int main(void){
+	char mem[32]; 
+	struct blob blob; 
+
+	TEST(!blob_init_fixed(&blob, mem, 2)); 
+	TEST(blob_init_fixed(&blob, mem, sizeof(mem))); 
+	TEST(blob.buf == mem); 
+
+	blob_offset_t o = blob_open_table(&blob); 
+	TEST(o != 0); 
+	TEST(blob_put_string(&blob, "id") != NULL); 
+	TEST(blob_put_int(&blob, 1234) != NULL); 
+	blob_close_table(&blob, o); 
+	TEST(blob_put_string(&blob, "cmd") != NULL); 
+
+	// 4 + 4 + 8 + 8 + 8 = 32 bytes used so far
+	TEST(blob_size(&blob) == 32); 
+	TEST(blob_put_string(&blob, "does not fit") == NULL); 
+	TEST(blob_put_attr(&blob, blob_field_first_child(blob_head(&blob))) == NULL); 
+	TEST(blob_open_array(&blob) == 0); 
+	blob_close_array(&blob, 0); 
+
+	// a failed write leaves the content intact
+	TEST(blob_size(&blob) == 32); 
+	TEST(blob.buf == mem); 
+	TEST(blob_field_validate(blob_head(&blob), "ts")); 
+
+	// json is parsed up to the point where the buffer is full
+	blob_reset(&blob); 
+	TEST(!blob_put_json(&blob, "{\"a\":\"a string that is far too long for the buffer\"}")); 
+
+	// long escaped strings need decoder memory which a fixed blob can not provide so it comes from the default allocator
+	char big[256]; 
+	TEST(blob_init_fixed(&blob, big, sizeof(big))); 
+	TEST(blob_put_json(&blob, "{\"a\":\"a string with an \\\"escape\\\" that is longer than the sixty four bytes the decoder keeps on its stack\"}")); 
+	const struct blob_field *tbl = blob_field_first_child(blob_head(&blob)); 
+	TEST(strlen(blob_field_get_string(blob_field_next_child(tbl, blob_field_first_child(tbl)))) > 64); 
+
+	// tables too large for the stack are sorted with scratch memory from the default allocator
+	char table[2048]; 
+	TEST(blob_init_fixed(&blob, table, sizeof(table))); 
+	blob_offset_t t = blob_open_table(&blob); 
+	for(int c = 99; c >= 0; c--){
+		char key[8]; 
+		snprintf(key, sizeof(key), "k%02d", c); 
+		blob_put_string(&blob, key); 
+		blob_put_int(&blob, c); 
+	}
+	TEST(blob_close_table_sorted(&blob, t)); 
+	tbl = blob_field_first_child(blob_head(&blob)); 
+	TEST(blob_field_is_sorted(tbl)); 
+	TEST(strcmp(blob_field_get_string(blob_field_first_child(tbl)), "k00") == 0); 
+	TEST(blob_field_get_int(blob_table_find(tbl, "k42")) == 42); 
+
+	// garbage left in reused memory never leaks into the output
+	char dirty[64]; 
+	struct blob clean; 
+	memset(dirty, 0xff, sizeof(dirty)); 
+	TEST(blob_init_fixed(&blob, dirty, sizeof(dirty))); 
+	blob_init(&clean, 0, 0); 
+	blob_put_string(&blob, "ab"); 
+	blob_put_string(&clean, "ab"); 
+	blob_put_int(&blob, 7); 
+	blob_put_int(&clean, 7); 
+	TEST(blob_size(&blob) == blob_size(&clean)); 
+	TEST(memcmp(blob.buf, clean.buf, blob_size(&blob)) == 0); 
+	// reserved binary space as well
+	const struct blob_field *bin = blob_put_binary(&blob, NULL, 6); 
+	blob_put_binary(&clean, "\0\0\0\0\0\0", 6); 
+	TEST(bin != NULL); 
+	TEST(memcmp(blob.buf, clean.buf, blob_size(&blob)) == 0); 
+	blob_free(&clean); 
+
+	blob_free(&blob); 
+	return 0; 
+}
@@ -0,0 +1,125 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+
+static void build(struct blob *b){
+	blob_offset_t t = blob_open_table(b); 
+	blob_put_string(b, "on"); 
+	blob_put_bool(b, true); 
+	blob_put_string(b, "off"); 
+	blob_put_bool(b, false); 
+	blob_put_string(b, "none"); 
+	blob_put_null(b); 
+	blob_put_string(b, "small"); 
+	blob_put_int(b, -5); 
+	blob_put_string(b, "max"); 
+	blob_put_int(b, BLOB_FIELD_IMM_MAX); 
+	blob_put_string(b, "min"); 
+	blob_put_int(b, BLOB_FIELD_IMM_MIN); 
+	blob_put_string(b, "big"); 
+	blob_put_int(b, BLOB_FIELD_IMM_MAX + 1); 
+	blob_close_table(b, t); 
+}
+
+int main(void){
+	struct blob plain, b; 
+	blob_init(&plain, 0, 0); 
+	blob_init(&b, 0, 0); 
+	build(&plain); 
+	blob_set_inline(&b, true); 
+	build(&b); 
+
+	// header only fields take half the space of one byte fields
+	printf("plain %u bytes, inline %u bytes\n", (unsigned)blob_size(&plain), (unsigned)blob_size(&b)); 
+	TEST(blob_size(&b) == blob_size(&plain) - 6 * 4); 
+	TEST(blob_field_check(blob_head(&b), blob_size(&b))); 
+	TEST(blob_field_validate(blob_field_first_child(blob_head(&b)), "sisisisisisisi")); 
+
+	const struct blob_field *tbl = blob_field_first_child(blob_head(&b)); 
+	const struct blob_field *key, *value; 
+	long long expect[] = { 1, 0, 0, -5, BLOB_FIELD_IMM_MAX, BLOB_FIELD_IMM_MIN, BLOB_FIELD_IMM_MAX + 1 }; 
+	int types[] = { BLOB_FIELD_BOOL, BLOB_FIELD_BOOL, BLOB_FIELD_NULL, BLOB_FIELD_IMM, BLOB_FIELD_IMM, BLOB_FIELD_IMM, BLOB_FIELD_INT32 }; 
+	int count = 0; 
+	blob_field_for_each_kv(tbl, key, value){
+		TEST(blob_field_type(value) == types[count]); 
+		TEST(blob_field_get_int(value) == expect[count]); 
+		TEST(blob_field_get_real(value) == (double)expect[count]); 
+		TEST(blob_field_get_bool(value) == !!expect[count]); 
+		count++; 
+	}
+	TEST(count == 7); 
+
+	// json export keeps null and bools
+	char *json = blob_field_to_json(tbl); 
+	printf("%s\n", json); 
+	TEST(strcmp(json, "{\"on\":true,\"off\":false,\"none\":null,\"small\":-5,\"max\":8388607,\"min\":-8388608,\"big\":8388608}") == 0); 
+	free(json); 
+
+	// and json import writes inline fields when the blob allows it
+	struct blob j; 
+	blob_init(&j, 0, 0); 
+	blob_set_inline(&j, true); 
+	TEST(blob_put_json(&j, "{\"on\":true,\"off\":false,\"none\":null,\"small\":-5,\"max\":8388607,\"min\":-8388608,\"big\":8388608}")); 
+	TEST(blob_size(&j) == blob_size(&b)); 
+	TEST(memcmp(j.buf, b.buf, blob_size(&b)) == 0); 
+	blob_free(&j); 
+
+	// bulk writes follow the same rules
+	struct blob one, bulk; 
+	blob_init(&one, 0, 0); 
+	blob_init(&bulk, 0, 0); 
+	blob_set_inline(&one, true); 
+	blob_set_inline(&bulk, true); 
+	int64_t ints[] = { 0, 1, -1, 1000, 1 << 23, -(1 << 23), 1LL << 40 }; 
+	blob_offset_t o = blob_open_array(&one); 
+	for(int c = 0; c < 7; c++) blob_put_int(&one, ints[c]); 
+	blob_close_array(&one, o); 
+	blob_put_int_array(&bulk, ints, 7); 
+	TEST(blob_size(&one) == blob_size(&bulk)); 
+	TEST(memcmp(one.buf, bulk.buf, blob_size(&one)) == 0); 
+	blob_free(&one); 
+	blob_free(&bulk); 
+
+	// the compact encoding keeps inline values and decodes to the same blob
+	size_t size = blob_compact_size(blob_head(&b)); 
+	uint8_t out[size]; 
+	TEST(blob_compact_encode(blob_head(&b), out, size) == size); 
+	struct blob d; 
+	blob_init(&d, 0, 0); 
+	TEST(blob_compact_decode(&d, out, size)); 
+	TEST(blob_size(&d) == blob_size(&b)); 
+	TEST(memcmp(d.buf, b.buf, blob_size(&b)) == 0); 
+	struct blob_value root, t, item; 
+	TEST(blob_value_init(&root, out, size)); 
+	TEST(blob_value_first_child(&root, &t)); 
+	count = 0; 
+	for(bool ok = blob_value_first_child(&t, &item); ok; ok = blob_value_next_child(&t, &item)){
+		if(count & 1) { TEST(blob_value_get_int(&item) == expect[count / 2]); }
+		count++; 
+	}
+	TEST(count == 14); 
+	blob_free(&d); 
+
+	// bad values are rejected by the checker
+	blob_put_bool(&b, true); 
+	struct blob_field *f = (struct blob_field*)(void*)((char*)b.buf + blob_size(&b) - 4); 
+	TEST(blob_field_check(blob_head(&b), blob_size(&b))); 
+	f->id_len = htobe32(((uint32_t)BLOB_FIELD_BOOL << BLOB_FIELD_ID_SHIFT) | 2); 
+	TEST(!blob_field_check(blob_head(&b), blob_size(&b))); 
+
+	// nothing changes for blobs that do not enable it
+	TEST(blob_field_type(blob_field_first_child(blob_head(&plain))) == BLOB_FIELD_TABLE); 
+	blob_reset(&plain); 
+	blob_put_bool(&plain, true); 
+	blob_put_null(&plain); 
+	TEST(blob_field_type(blob_field_first_child(blob_head(&plain))) == BLOB_FIELD_INT8); 
+	blob_set_inline(&b, false); 
+	blob_reset(&b); 
+	blob_put_int(&b, 1); 
+	TEST(blob_field_type(blob_field_first_child(blob_head(&b))) == BLOB_FIELD_INT8); 
+
+	blob_free(&plain); 
+	blob_free(&b); 
+	return 0; 
+}
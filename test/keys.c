@@ -0,0 +1,174 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+
+static const char *names[] = { "id", "timestamp", "temperature", "humidity", "status" }; 
+
+static void build(struct blob *b, int records){
+	blob_offset_t a = blob_open_array(b); 
+	for(int c = 0; c < records; c++){
+		blob_offset_t t = blob_open_table(b); 
+		for(int k = 0; k < 5; k++){
+			blob_put_key(b, names[k]); 
+			blob_put_int(b, c * 10 + k); 
+		}
+		blob_close_table(b, t); 
+	}
+	blob_close_array(b, a); 
+}
+
+int main(void){
+	struct blob plain, b; 
+	blob_init(&plain, 0, 0); 
+	blob_init(&b, 0, 0); 
+	build(&plain, 1000); 
+	TEST(blob_set_intern_keys(&b, true)); 
+	build(&b, 1000); 
+
+	// every key after the first record is a 4 byte reference
+	printf("plain %u bytes, interned %u bytes\n", (unsigned)blob_size(&plain), (unsigned)blob_size(&b)); 
+	TEST(blob_size(&b) < blob_size(&plain) * 2 / 3); 
+	TEST(blob_field_check(blob_head(&b), blob_size(&b))); 
+
+	// keys still read back as strings
+	const struct blob_field *records = blob_field_first_child(blob_head(&b)); 
+	const struct blob_field *rec, *key, *value; 
+	int count = 0; 
+	blob_field_for_each_child(records, rec){
+		int k = 0; 
+		blob_field_for_each_kv(rec, key, value){
+			TEST(strcmp(blob_field_get_string(key), names[k]) == 0); 
+			TEST(blob_field_get_int(value) == count * 10 + k); 
+			k++; 
+		}
+		TEST(blob_field_validate(rec, "sisisisisi")); 
+		count++; 
+	}
+	TEST(count == 1000); 
+	rec = blob_field_next_child(records, blob_field_first_child(records)); 
+	TEST(blob_field_type(blob_field_first_child(rec)) == BLOB_FIELD_KEYREF); 
+
+	struct blob_policy policy[] = {
+		{ .name = "humidity", .type = BLOB_FIELD_ANY }, 
+		{ .name = "id", .type = BLOB_FIELD_ANY }
+	}; 
+	blob_field_parse_values(rec, policy, 2); 
+	TEST(policy[0].value && policy[1].value); 
+	TEST(blob_field_get_int(policy[0].value) == 13 && blob_field_get_int(policy[1].value) == 10); 
+
+	// json is the same as without the dictionary
+	char *j1 = blob_to_json(&plain); 
+	char *j2 = blob_to_json(&b); 
+	TEST(strcmp(j1, j2) == 0); 
+
+	// and json import interns object keys
+	struct blob j; 
+	blob_init(&j, 0, 0); 
+	TEST(blob_set_intern_keys(&j, true)); 
+	TEST(blob_put_json(&j, j1)); 
+	// the export wraps the root array into another one
+	const struct blob_field *inner = blob_field_first_child(blob_head(&j)); 
+	TEST(blob_size(&j) == blob_size(&b) + 4); 
+	TEST(memcmp(inner, b.buf, blob_size(&b)) == 0); 
+	blob_free(&j); 
+	free(j1); 
+	free(j2); 
+
+	// measuring gives the exact size
+	struct blob m; 
+	blob_init_measure(&m); 
+	TEST(blob_set_intern_keys(&m, true)); 
+	build(&m, 1000); 
+	TEST(blob_measured_size(&m) == blob_size(&b)); 
+	blob_free(&m); 
+
+	// compact encoding writes the keys out again
+	size_t size = blob_compact_size(blob_head(&b)); 
+	uint8_t *out = malloc(size); 
+	TEST(blob_compact_encode(blob_head(&b), out, size) == size); 
+	struct blob d; 
+	blob_init(&d, 0, 0); 
+	TEST(blob_compact_decode(&d, out, size)); 
+	TEST(blob_size(&d) == blob_size(&plain)); 
+	TEST(memcmp(d.buf, plain.buf, blob_size(&plain)) == 0); 
+	blob_free(&d); 
+	free(out); 
+
+	// copies of a record do not depend on the strings in front of it
+	struct blob copy; 
+	blob_init(&copy, 0, 0); 
+	TEST(blob_put_attr(&copy, rec) != NULL); 
+	TEST(blob_field_check(blob_head(&copy), blob_size(&copy))); 
+	const struct blob_field *crec = blob_field_first_child(blob_head(&copy)); 
+	TEST(blob_field_validate(crec, "sisisisisi")); 
+	TEST(blob_field_type(blob_field_first_child(crec)) == BLOB_FIELD_STRING); 
+	TEST(strcmp(blob_field_get_string(blob_field_first_child(crec)), "id") == 0); 
+	// the first record holds the strings themselves and is copied as it is
+	TEST(blob_put_attr(&copy, blob_field_first_child(records)) != NULL); 
+	TEST(blob_field_equal(blob_field_next_child(blob_head(&copy), crec), blob_field_first_child(records))); 
+	// and so is a copy of the whole list
+	blob_reset(&copy); 
+	TEST(blob_put_attr(&copy, records) != NULL); 
+	TEST(blob_field_equal(blob_field_first_child(blob_head(&copy)), records)); 
+	blob_free(&copy); 
+
+	struct blob_rope rope; 
+	struct blob flat; 
+	blob_rope_init(&rope, NULL, 0); 
+	blob_init(&flat, 0, 0); 
+	TEST(blob_rope_put_attr(&rope, rec)); 
+	TEST(blob_rope_flatten(&rope, &flat)); 
+	TEST(blob_field_check(blob_head(&flat), blob_size(&flat))); 
+	TEST(blob_field_validate(blob_field_first_child(blob_head(&flat)), "sisisisisi")); 
+	blob_free(&flat); 
+	blob_rope_free(&rope); 
+
+	// copies inside the same blob survive the buffer moving while it grows
+	struct blob self; 
+	blob_init(&self, 0, 0); 
+	TEST(blob_set_intern_keys(&self, true)); 
+	build(&self, 2); 
+	while(self.memlen - blob_size(&self) >= 64) blob_put_int(&self, 0); 
+	size_t before = self.memlen; 
+	records = blob_field_first_child(blob_head(&self)); 
+	rec = blob_field_next_child(records, blob_field_first_child(records)); 
+	const struct blob_field *last = blob_put_attr(&self, rec); 
+	TEST(last != NULL); 
+	TEST(self.memlen != before); 
+	TEST(blob_field_check(blob_head(&self), blob_size(&self))); 
+	TEST(blob_field_validate(last, "sisisisisi")); 
+	TEST(blob_field_get_int(blob_field_next_child(last, blob_field_first_child(last))) == 10); 
+	blob_free(&self); 
+
+	// reset forgets all keys
+	blob_reset(&b); 
+	blob_put_key(&b, "id"); 
+	TEST(blob_field_type(blob_field_first_child(blob_head(&b))) == BLOB_FIELD_STRING); 
+	blob_put_key(&b, "id"); 
+	blob_put_key(&b, "other"); 
+	struct blob_field *ref = (struct blob_field*)(void*)((char*)b.buf + 4 + 8); // root header and "id"
+	TEST(blob_field_type(ref) == BLOB_FIELD_KEYREF); 
+	TEST(blob_field_check(blob_head(&b), blob_size(&b))); 
+
+	// references that do not point at a string inside the message are rejected
+	uint32_t saved = ref->id_len; 
+	ref->id_len = htobe32(((uint32_t)BLOB_FIELD_KEYREF << BLOB_FIELD_ID_SHIFT) | 1); 
+	TEST(!blob_field_check(blob_head(&b), blob_size(&b))); 
+	ref->id_len = htobe32(((uint32_t)BLOB_FIELD_KEYREF << BLOB_FIELD_ID_SHIFT) | 3); 
+	TEST(!blob_field_check(blob_head(&b), blob_size(&b))); 
+	ref->id_len = htobe32(((uint32_t)BLOB_FIELD_KEYREF << BLOB_FIELD_ID_SHIFT)); 
+	TEST(!blob_field_check(blob_head(&b), blob_size(&b))); 
+	ref->id_len = saved; 
+	TEST(blob_field_check(blob_head(&b), blob_size(&b))); 
+	TEST(!blob_field_check(ref, 4)); 
+
+	// without the dictionary keys are plain strings
+	TEST(blob_set_intern_keys(&b, false)); 
+	blob_put_key(&b, "id"); 
+	TEST(blob_field_validate(blob_head(&b), "ssss")); 
+
+	blob_free(&plain); 
+	blob_free(&b); 
+	return 0; 
+}
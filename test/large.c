@@ -0,0 +1,138 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <memory.h>
+
+#define BIG_STRING_LEN (17 * 1024 * 1024)
+#define BIG_ARRAY_COUNT (2200000)
+
+int main(void){
+	struct blob blob;
+	blob_init(&blob, 0, 0);
+
+	// default limit still applies
+	char *str = malloc(BIG_STRING_LEN + 1);
+	memset(str, 'a', BIG_STRING_LEN);
+	str[BIG_STRING_LEN] = 0;
+	TEST(blob_put_string(&blob, str) == NULL);
+	TEST(blob_size(&blob) == sizeof(struct blob_field));
+
+	blob_set_max_size(&blob, 64 * 1024 * 1024);
+
+	TEST(blob_put_int(&blob, 1) != NULL);
+	TEST(!blob_field_is_extended(blob_head(&blob)));
+
+	// a single field that does not fit into a short header
+	const struct blob_field *f = blob_put_string(&blob, str);
+	TEST(f != NULL);
+	TEST(blob_field_is_extended(blob_head(&blob)));
+	f = blob_field_next_child(blob_head(&blob), blob_field_first_child(blob_head(&blob)));
+	TEST(blob_field_is_extended(f));
+	TEST(blob_field_data_len(f) == BIG_STRING_LEN + 1);
+	TEST(strcmp(blob_field_get_string(f), str) == 0);
+
+	// a container that only becomes too large once it is closed
+	blob_offset_t o = blob_open_array(&blob);
+	for(int c = 0; c < BIG_ARRAY_COUNT; c++){
+		blob_put_int(&blob, c & 0x7f);
+	}
+	blob_close_array(&blob, o);
+	TEST(blob_put_int(&blob, 2) != NULL);
+
+	const struct blob_field *child = blob_field_first_child(blob_head(&blob));
+	TEST(blob_field_get_int(child) == 1);
+	child = blob_field_next_child(blob_head(&blob), child);
+	TEST(blob_field_type(child) == BLOB_FIELD_STRING);
+	child = blob_field_next_child(blob_head(&blob), child);
+	TEST(blob_field_type(child) == BLOB_FIELD_ARRAY);
+	TEST(blob_field_is_extended(child));
+
+	const struct blob_field *item;
+	int count = 0;
+	bool valid = true;
+	blob_field_for_each_child(child, item){
+		if(blob_field_get_int(item) != (count & 0x7f)) valid = false;
+		count++;
+	}
+	TEST(valid);
+	TEST(count == BIG_ARRAY_COUNT);
+
+	child = blob_field_next_child(blob_head(&blob), child);
+	TEST(blob_field_get_int(child) == 2);
+	TEST(blob_field_next_child(blob_head(&blob), child) == NULL);
+
+	// limit is enforced for growth as well
+	blob_set_max_size(&blob, blob_size(&blob) + 64);
+	TEST(blob_put_string(&blob, str) == NULL);
+
+	// a container that can not get its extended header stays open
+	struct blob big;
+	blob_init(&big, 0, 0);
+	blob_set_max_size(&big, 64 * 1024 * 1024);
+	o = blob_open_array(&big);
+	TEST(blob_put_string(&big, str) != NULL);
+	size_t size = blob_size(&big);
+	blob_set_max_size(&big, size);
+	TEST(!blob_close_array(&big, o));
+	TEST(blob_size(&big) == size);
+	blob_set_max_size(&big, 64 * 1024 * 1024);
+	TEST(blob_close_array(&big, o));
+	child = blob_field_first_child(blob_head(&big));
+	TEST(blob_field_is_extended(child));
+	TEST(strcmp(blob_field_get_string(blob_field_first_child(child)), str) == 0);
+	TEST(!blob_close_array(&big, 0));
+	blob_free(&big);
+
+	// key references keep pointing at their strings when a container gets an extended header
+	struct blob keys;
+	blob_init(&keys, 0, 0);
+	blob_set_max_size(&keys, 64 * 1024 * 1024);
+	TEST(blob_set_intern_keys(&keys, true));
+	blob_put_key(&keys, "outer");
+	o = blob_open_array(&keys);
+	blob_put_key(&keys, "outer");
+	blob_put_key(&keys, "inner");
+	TEST(blob_put_binary(&keys, NULL, BIG_STRING_LEN) != NULL);
+	blob_put_key(&keys, "outer");
+	// the header does not fit so the array stays open
+	size = blob_size(&keys);
+	blob_set_max_size(&keys, size);
+	TEST(!blob_close_array(&keys, o));
+	TEST(blob_size(&keys) == size);
+	blob_set_max_size(&keys, 64 * 1024 * 1024);
+	TEST(blob_close_array(&keys, o));
+	blob_put_key(&keys, "inner");
+	TEST(blob_field_check(blob_head(&keys), blob_size(&keys)));
+	child = blob_field_next_child(blob_head(&keys), blob_field_first_child(blob_head(&keys)));
+	TEST(blob_field_is_extended(child));
+	item = blob_field_first_child(child);
+	TEST(blob_field_type(item) == BLOB_FIELD_KEYREF);
+	TEST(strcmp(blob_field_get_string(item), "outer") == 0);
+	item = blob_field_next_child(child, item);
+	TEST(strcmp(blob_field_get_string(item), "inner") == 0);
+	item = blob_field_next_child(child, blob_field_next_child(child, item));
+	TEST(blob_field_type(item) == BLOB_FIELD_KEYREF);
+	TEST(strcmp(blob_field_get_string(item), "outer") == 0);
+	item = blob_field_next_child(blob_head(&keys), child);
+	TEST(blob_field_type(item) == BLOB_FIELD_KEYREF);
+	TEST(strcmp(blob_field_get_string(item), "inner") == 0);
+	blob_free(&keys);
+
+	// a named field of the old format has the top bit set and its size in the low bits
+	uint32_t old[4];
+	old[0] = htobe32(0x80000000 | ((uint32_t)BLOB_FIELD_ARRAY << BLOB_FIELD_ID_SHIFT) | sizeof(old));
+	old[1] = 0;
+	old[2] = htobe32(sizeof(old));
+	old[3] = htobe32((uint32_t)BLOB_FIELD_NULL << BLOB_FIELD_ID_SHIFT);
+	TEST(!blob_field_check((const struct blob_field*)old, sizeof(old)));
+	TEST(!blob_check_head(old, sizeof(old)));
+	// with the size only in the 64 bit word the same bytes are an extended field
+	old[0] = htobe32(0x80000000 | ((uint32_t)BLOB_FIELD_ARRAY << BLOB_FIELD_ID_SHIFT));
+	TEST(blob_field_check((const struct blob_field*)old, sizeof(old)));
+	TEST(blob_check_head(old, sizeof(old)));
+
+	free(str);
+	blob_free(&blob);
+	return 0;
+}
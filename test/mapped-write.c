@@ -0,0 +1,67 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static void build(struct blob *b){
+	blob_offset_t a = blob_open_array(b); 
+	for(int c = 0; c < 100000; c++){
+		blob_put_string(b, "some text to make the file grow"); 
+		blob_put_int(b, c); 
+	}
+	blob_close_array(b, a); 
+}
+
+int main(void){
+	char path[] = "/tmp/blobpack-mapped-XXXXXX"; 
+	int fd = mkstemp(path); 
+	TEST(fd >= 0); 
+	close(fd); 
+
+	struct blob file, mem, map; 
+	TEST(blob_create_mapped(&file, path)); 
+	blob_init(&mem, 0, 0); 
+	build(&file); 
+	build(&mem); 
+
+	TEST(blob_size(&file) == blob_size(&mem)); 
+	TEST(blob_size(&file) > 4 * 1024 * 1024); 
+	TEST(memcmp(file.buf, mem.buf, blob_size(&mem)) == 0); 
+	TEST(blob_sync(&file)); 
+	TEST(!blob_sync(&mem)); 
+	blob_free(&file); 
+
+	// the file holds exactly the message
+	struct stat st; 
+	TEST(stat(path, &st) == 0); 
+	TEST((size_t)st.st_size == blob_size(&mem)); 
+
+	TEST(blob_open_mapped(&map, path)); 
+	TEST(blob_field_check(blob_head(&map), map.memlen)); 
+	TEST(memcmp(map.buf, mem.buf, blob_size(&mem)) == 0); 
+	blob_free(&map); 
+
+	// creating again starts from an empty blob and leaves readers of the old file alone
+	TEST(blob_open_mapped(&map, path)); 
+	TEST(blob_create_mapped(&file, path)); 
+	TEST(blob_size(&file) == sizeof(struct blob_field)); 
+	TEST(memcmp(map.buf, mem.buf, blob_size(&mem)) == 0); 
+	blob_free(&map); 
+
+	// mapped blobs can not be detached
+	size_t len = 1, cap = 1; 
+	TEST(blob_detach(&file, &len, &cap) == NULL); 
+	TEST(len == 0 && cap == 0); 
+	TEST(file.buf != NULL); 
+	blob_free(&file); 
+	TEST(stat(path, &st) == 0); 
+	TEST((size_t)st.st_size == sizeof(struct blob_field)); 
+
+	TEST(!blob_create_mapped(&file, "/nonexistent/dir/file.blob")); 
+
+	unlink(path); 
+	blob_free(&mem); 
+	return 0; 
+}
@@ -0,0 +1,63 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+#include <unistd.h>
+
+static void write_file(const char *path, const void *data, size_t size){
+	FILE *fp = fopen(path, "w"); 
+	TEST(fp != NULL); 
+	TEST(fwrite(data, 1, size, fp) == size); 
+	fclose(fp); 
+}
+
+int main(void){
+	char path[] = "/tmp/blobpack-mapped-XXXXXX"; 
+	int fd = mkstemp(path); 
+	TEST(fd >= 0); 
+	close(fd); 
+
+	struct blob src, map; 
+	blob_init(&src, 0, 0); 
+	blob_offset_t t = blob_open_table(&src); 
+	for(int c = 0; c < 1000; c++){
+		char key[16]; 
+		snprintf(key, sizeof(key), "key%d", c); 
+		blob_put_string(&src, key); 
+		blob_put_int(&src, c * 7); 
+	}
+	blob_close_table(&src, t); 
+	write_file(path, src.buf, blob_size(&src)); 
+
+	TEST(blob_open_mapped(&map, path)); 
+	TEST(blob_size(&map) == blob_size(&src)); 
+	TEST(memcmp(map.buf, src.buf, blob_size(&src)) == 0); 
+	TEST(blob_field_check(blob_head(&map), map.memlen)); 
+
+	const struct blob_field *key, *value; 
+	int count = 0; 
+	blob_field_for_each_kv(blob_field_first_child(blob_head(&map)), key, value){
+		TEST(blob_field_get_int(value) == count * 7); 
+		count++; 
+	}
+	TEST(count == 1000); 
+
+	// the mapping is read only
+	TEST(blob_put_int(&map, 1) == NULL); 
+	blob_reset(&map); 
+	TEST(blob_size(&map) == blob_size(&src)); 
+	blob_free(&map); 
+	TEST(map.buf == NULL); 
+
+	// the header must fit into the file
+	write_file(path, src.buf, blob_size(&src) - 4); 
+	TEST(!blob_open_mapped(&map, path)); 
+	write_file(path, src.buf, 2); 
+	TEST(!blob_open_mapped(&map, path)); 
+
+	unlink(path); 
+	TEST(!blob_open_mapped(&map, path)); 
+
+	blob_free(&src); 
+	return 0; 
+}
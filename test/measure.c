@@ -0,0 +1,122 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+
+struct tracker {
+	int allocs; 
+	int reallocs; 
+}; 
+
+static void *track_alloc(void *ctx, size_t size){
+	((struct tracker*)ctx)->allocs++; 
+	return malloc(size); 
+}
+
+static void *track_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size){
+	((struct tracker*)ctx)->reallocs++; 
+	return realloc(ptr, new_size); 
+}
+
+static void track_free(void *ctx, void *ptr, size_t size){
+	free(ptr); 
+}
+
+static void build(struct blob *b){
+	struct blob other; 
+	blob_init(&other, 0, 0); 
+	blob_put_string(&other, "copied"); 
+	blob_put_int(&other, 100000); 
+
+	blob_offset_t t = blob_open_table(b); 
+	blob_put_string(b, "int8"); 
+	blob_put_int(b, 12); 
+	blob_put_string(b, "int16"); 
+	blob_put_int(b, 1234); 
+	blob_put_string(b, "int32"); 
+	blob_put_int(b, 123456); 
+	blob_put_string(b, "int64"); 
+	blob_put_int(b, 1LL << 40); 
+	blob_put_string(b, "float"); 
+	blob_put_real(b, 0.5); 
+	blob_put_string(b, "double"); 
+	blob_put_real(b, 0.1); 
+	blob_put_string(b, "bool"); 
+	blob_put_bool(b, true); 
+	blob_put_string(b, "array"); 
+	blob_offset_t a = blob_open_array(b); 
+	for(int c = 0; c < 100; c++) blob_put_int(b, c * c); 
+	blob_offset_t e = blob_open_array(b); 
+	blob_close_array(b, e); 
+	blob_close_array(b, a); 
+	blob_close_table(b, t); 
+	blob_put_attr(b, blob_field_first_child(blob_head(&other))); 
+	blob_put_attr(b, blob_head(&other)); 
+	blob_put_string(b, ""); 
+	blob_put_json(b, "{\"json\":[1,2.5,\"three\",{\"four\":true}]}"); 
+
+	blob_free(&other); 
+}
+
+int main(void){
+	struct tracker t = {0}; 
+	const struct blob_allocator alloc = {
+		.alloc = track_alloc, 
+		.realloc = track_realloc, 
+		.free = track_free, 
+		.ctx = &t
+	}; 
+	struct blob m, b, ref; 
+
+	blob_init_measure(&m); 
+	TEST(blob_measured_size(&m) == sizeof(struct blob_field)); 
+	build(&m); 
+	size_t size = blob_measured_size(&m); 
+
+	blob_init(&ref, 0, 0); 
+	build(&ref); 
+	TEST(size == blob_size(&ref)); 
+
+	// second pass allocates exactly once
+	blob_init_alloc(&b, &alloc, NULL, size); 
+	build(&b); 
+	TEST(t.allocs == 1); 
+	TEST(t.reallocs == 0); 
+	TEST(b.memlen == size); 
+	TEST(blob_size(&b) == size); 
+	TEST(memcmp(b.buf, ref.buf, size) == 0); 
+
+	// measuring does not allocate or write anything
+	TEST(m.buf == NULL); 
+	blob_reset(&m); 
+	TEST(blob_measured_size(&m) == sizeof(struct blob_field)); 
+
+	// the size limit applies the same way as when writing
+	blob_set_max_size(&m, 64); 
+	TEST(blob_put_string(&m, "fits") != NULL); 
+	TEST(blob_put_string(&m, "this string does not fit into the limit of the blob at all") == NULL); 
+	blob_set_max_size(&m, 0); 
+
+	// containers and the root that grow over 16MB get extended headers
+	blob_reset(&m); 
+	blob_set_max_size(&m, 64 * 1024 * 1024); 
+	blob_set_max_size(&ref, 64 * 1024 * 1024); 
+	blob_reset(&ref); 
+	struct blob *both[] = { &m, &ref }; 
+	for(int i = 0; i < 2; i++){
+		blob_put_int(both[i], 1); 
+		blob_offset_t o = blob_open_array(both[i]); 
+		for(int c = 0; c < 2200000; c++) blob_put_int(both[i], c & 0x7f); 
+		blob_offset_t inner = blob_open_table(both[i]); 
+		blob_close_table(both[i], inner); 
+		blob_close_array(both[i], o); 
+		blob_put_int(both[i], 2); 
+	}
+	TEST(blob_field_is_extended(blob_head(&ref))); 
+	TEST(blob_measured_size(&m) == blob_size(&ref)); 
+
+	blob_free(&m); 
+	blob_free(&b); 
+	blob_free(&ref); 
+	return 0; 
+}
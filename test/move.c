@@ -0,0 +1,55 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+
+int main(void){
+	struct blob a, b; 
+	blob_init(&a, 0, 0); 
+	for(int c = 0; c < 100; c++) blob_put_int(&a, c); 
+	size_t size = blob_size(&a); 
+	void *orig = a.buf; 
+
+	size_t cap = a.memlen; 
+	size_t len = 0, detached_cap = 0; 
+	void *mem = blob_detach(&a, &len, &detached_cap); 
+	TEST(mem == orig); 
+	TEST(len == size); 
+	TEST(detached_cap == cap && cap >= len); 
+	TEST(a.buf == NULL); 
+	blob_free(&a); 
+
+	// the buffer moves into another blob without being copied
+	TEST(blob_adopt(&b, mem, detached_cap)); 
+	TEST(b.buf == mem); 
+	TEST(b.memlen == cap); 
+	TEST(blob_size(&b) == size); 
+	const struct blob_field *child; 
+	int count = 0; 
+	blob_field_for_each_child(blob_head(&b), child){
+		TEST(blob_field_get_int(child) == count); 
+		count++; 
+	}
+	TEST(count == 100); 
+
+	// and can be written to as usual
+	TEST(blob_put_string(&b, "more") != NULL); 
+	TEST(blob_size(&b) > size); 
+	blob_free(&b); 
+
+	// buffers that do not start with a root element are not taken over
+	uint32_t *bad = calloc(4, sizeof(uint32_t)); 
+	TEST(!blob_adopt(&b, bad, 4 * sizeof(uint32_t))); 
+	blob_init(&a, 0, 0); 
+	for(int c = 0; c < 10; c++) blob_put_int(&a, c); 
+	memcpy(bad, a.buf, 4 * sizeof(uint32_t)); 
+	TEST(!blob_adopt(&b, bad, 4 * sizeof(uint32_t))); 
+	TEST(!blob_adopt(&b, NULL, 16)); 
+	free(bad); 
+
+	// detaching an empty blob
+	blob_free(&a); 
+	TEST(blob_detach(&a, &len, &detached_cap) == NULL); 
+	TEST(len == 0 && detached_cap == 0); 
+	return 0; 
+}
@@ -0,0 +1,79 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+
+static const char *json = "{\"a\":{\"b\":[10,11,12,{\"c\":\"deep\"}]},\"items\":[{\"id\":1},{\"id\":2},{\"name\":\"none\"},{\"id\":3}],\"m\":{\"x\":{\"v\":5},\"y\":{\"v\":6}}}"; 
+
+static long long get_int(const struct blob_field *root, const char *str){
+	struct blob_path *path = blob_path_compile(str); 
+	TEST(path != NULL); 
+	const struct blob_field *f = blob_path_get(root, path); 
+	blob_path_free(path); 
+	return (f)?blob_field_get_int(f):-1; 
+}
+
+int main(void){
+	struct blob b; 
+	blob_init(&b, 0, 0); 
+	TEST(blob_put_json(&b, json)); 
+	const struct blob_field *root = blob_field_first_child(blob_head(&b)); 
+
+	struct blob_path *path = blob_path_compile("a.b[3].c"); 
+	TEST(path && path->count == 4); 
+	TEST(strcmp(blob_field_get_string(blob_path_get(root, path)), "deep") == 0); 
+	blob_path_free(path); 
+
+	TEST(get_int(root, "a.b[0]") == 10); 
+	TEST(get_int(root, "a.b[2]") == 12); 
+	TEST(get_int(root, "a.b[4]") == -1); 
+	TEST(get_int(root, "a.c") == -1); 
+	TEST(get_int(root, "a.b.c") == -1); 
+	TEST(get_int(root, "m[1].v") == 6); 
+	TEST(get_int(root, "m.y.v") == 6); 
+	TEST(get_int(root, "a.b[0].x") == -1); 
+
+	// the same compiled path on another message
+	struct blob o; 
+	blob_init(&o, 0, 0); 
+	TEST(blob_put_json(&o, "{\"a\":{\"b\":[20,21]}}")); 
+	path = blob_path_compile("a.b[1]"); 
+	TEST(blob_field_get_int(blob_path_get(root, path)) == 11); 
+	TEST(blob_field_get_int(blob_path_get(blob_field_first_child(blob_head(&o)), path)) == 21); 
+	blob_path_free(path); 
+	blob_free(&o); 
+
+	// wildcards match every child
+	path = blob_path_compile("items[*].id"); 
+	TEST(path != NULL); 
+	const struct blob_field *out[8]; 
+	TEST(blob_path_get_all(root, path, out, 8) == 3); 
+	TEST(blob_field_get_int(out[0]) == 1 && blob_field_get_int(out[1]) == 2 && blob_field_get_int(out[2]) == 3); 
+	TEST(blob_field_get_int(blob_path_get(root, path)) == 1); 
+	TEST(blob_path_get_all(root, path, out, 2) == 3); 
+	TEST(blob_path_get_all(root, path, NULL, 0) == 3); 
+	blob_path_free(path); 
+
+	path = blob_path_compile("m.*.v"); 
+	TEST(blob_path_get_all(root, path, out, 8) == 2); 
+	TEST(blob_field_get_int(out[0]) == 5 && blob_field_get_int(out[1]) == 6); 
+	blob_path_free(path); 
+
+	// the empty path is the root itself
+	path = blob_path_compile(""); 
+	TEST(path && path->count == 0); 
+	TEST(blob_path_get(root, path) == root); 
+	blob_path_free(path); 
+	path = blob_path_compile("[0].a.b[1]"); 
+	TEST(blob_field_get_int(blob_path_get(blob_head(&b), path)) == 11); 
+	blob_path_free(path); 
+
+	// syntax errors
+	const char *bad[] = { ".a", "a.", "a..b", "a[", "a[]", "a[x]", "a[1", "a]b", "a[1]b", "a[-1]", "[99999999999999999999999]" }; 
+	for(size_t c = 0; c < sizeof(bad) / sizeof(bad[0]); c++) TEST(blob_path_compile(bad[c]) == NULL); 
+	TEST(blob_path_compile(NULL) == NULL); 
+	TEST(blob_path_get(NULL, NULL) == NULL); 
+
+	blob_free(&b); 
+	return 0; 
+}
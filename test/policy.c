@@ -0,0 +1,84 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+
+#define ENTRIES 6
+
+static const struct blob_policy template[ENTRIES] = {
+	{ .name = "id", .type = BLOB_FIELD_INT8 }, 
+	{ .name = "name", .type = BLOB_FIELD_STRING }, 
+	{ .name = "value", .type = BLOB_FIELD_ANY }, 
+	{ .name = "missing", .type = BLOB_FIELD_ANY }, 
+	{ .name = "id", .type = BLOB_FIELD_STRING }, // later entries of the same name are never used
+	{ .name = "list", .type = BLOB_FIELD_ARRAY }
+}; 
+
+//! parses attr with both functions and checks that they agree
+static bool parse_both(const struct blob_field *attr, struct blob_policy *out, int size){
+	struct blob_policy plain[ENTRIES], compiled[ENTRIES]; 
+	memcpy(plain, template, sizeof(plain)); 
+	memcpy(compiled, template, sizeof(compiled)); 
+	struct blob_policy_compiled *pc = blob_policy_compile(compiled, size); 
+	TEST(pc != NULL); 
+	bool r1 = blob_field_parse_values(attr, plain, size); 
+	bool r2 = blob_field_parse_compiled(attr, pc); 
+	blob_policy_free(pc); 
+	TEST(r1 == r2); 
+	for(int c = 0; c < ENTRIES; c++) TEST(plain[c].value == compiled[c].value); 
+	memcpy(out, compiled, sizeof(compiled)); 
+	return r2; 
+}
+
+int main(void){
+	struct blob b; 
+	struct blob_policy p[ENTRIES]; 
+	blob_init(&b, 0, 0); 
+
+	TEST(blob_put_json(&b, "{\"value\":1.5,\"extra\":true,\"name\":\"x\",\"id\":7,\"list\":[1,2]}")); 
+	const struct blob_field *tbl = blob_field_first_child(blob_head(&b)); 
+	TEST(parse_both(tbl, p, ENTRIES)); 
+	TEST(blob_field_get_int(p[0].value) == 7); 
+	TEST(strcmp(blob_field_get_string(p[1].value), "x") == 0); 
+	TEST(blob_field_get_real(p[2].value) == 1.5); 
+	TEST(p[3].value == NULL && p[4].value == NULL); 
+	TEST(blob_field_type(p[5].value) == BLOB_FIELD_ARRAY); 
+
+	// a value of the wrong type
+	blob_reset(&b); 
+	TEST(blob_put_json(&b, "{\"id\":\"seven\",\"name\":\"x\"}")); 
+	TEST(!parse_both(blob_field_first_child(blob_head(&b)), p, ENTRIES)); 
+	TEST(p[0].value == NULL && p[1].value != NULL); 
+
+	// more keys than the policy has entries
+	blob_reset(&b); 
+	TEST(blob_put_json(&b, "{\"id\":1,\"name\":\"x\",\"more\":2}")); 
+	TEST(!parse_both(blob_field_first_child(blob_head(&b)), p, 2)); 
+	TEST(blob_field_get_int(p[0].value) == 1); 
+
+	// arrays are matched by position
+	blob_reset(&b); 
+	TEST(blob_put_json(&b, "[1,\"x\",3]")); 
+	TEST(parse_both(blob_field_first_child(blob_head(&b)), p, ENTRIES)); 
+	TEST(blob_field_get_int(p[2].value) == 3); 
+
+	// interned keys
+	blob_reset(&b); 
+	TEST(blob_set_intern_keys(&b, true)); 
+	TEST(blob_put_json(&b, "[{\"id\":1,\"name\":\"a\"},{\"name\":\"b\",\"id\":2}]")); 
+	const struct blob_field *second = blob_field_next_child(blob_field_first_child(blob_head(&b)), blob_field_first_child(blob_field_first_child(blob_head(&b)))); 
+	TEST(blob_field_type(blob_field_first_child(second)) == BLOB_FIELD_KEYREF); 
+	TEST(parse_both(second, p, ENTRIES)); 
+	TEST(blob_field_get_int(p[0].value) == 2 && strcmp(blob_field_get_string(p[1].value), "b") == 0); 
+
+	// empty policy
+	struct blob_policy_compiled *pc = blob_policy_compile(p, 0); 
+	TEST(pc != NULL); 
+	TEST(!blob_field_parse_compiled(second, pc)); 
+	TEST(!blob_field_parse_compiled(NULL, pc)); 
+	blob_policy_free(pc); 
+	TEST(blob_policy_compile(NULL, 1) == NULL); 
+
+	blob_free(&b); 
+	return 0; 
+}
@@ -0,0 +1,128 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+#include <pthread.h>
+
+static void build(struct blob *b, int count){
+	blob_init(b, 0, 0); 
+	for(int c = 0; c < count; c++) blob_put_int(b, c); 
+}
+
+static void *worker(void *arg){
+	struct blob b; 
+	for(int c = 0; c < 100; c++){
+		build(&b, 50); 
+		blob_free(&b); 
+	}
+	return NULL; 
+}
+
+static pthread_barrier_t disabled; 
+static size_t retained_after_disable; 
+
+// fills its cache, waits until the pool is disabled and then frees a blob that still uses it
+static void *late_worker(void *arg){
+	struct blob b, held; 
+	for(int c = 0; c < 10; c++){
+		build(&b, 50); 
+		blob_free(&b); 
+	}
+	build(&held, 50); 
+	pthread_barrier_wait(&disabled); 
+	pthread_barrier_wait(&disabled); 
+	blob_free(&held); 
+	struct blob_pool_stats st; 
+	blob_pool_get_stats(&st); 
+	retained_after_disable = st.retained_bytes; 
+	return NULL; 
+}
+
+int main(void){
+	struct blob_pool_stats st; 
+	struct blob a, b; 
+
+	blob_pool_enable(NULL); 
+
+	build(&a, 500); 
+	blob_free(&a); 
+
+	blob_pool_get_stats(&st); 
+	TEST(st.hits == 0); 
+	TEST(st.retained_bytes > 0); 
+
+	// same shape again is served entirely from the thread cache
+	unsigned long long misses = st.misses; 
+	build(&a, 500); 
+	blob_pool_get_stats(&st); 
+	TEST(st.misses == misses); 
+	TEST(st.hits > 0); 
+	TEST(blob_field_get_int(blob_field_first_child(blob_head(&a))) == 0); 
+
+	// a reserve that fits the bucket of the buffer does not move it
+	blob_init(&b, 0, 0); 
+	void *mem = b.buf; 
+	TEST(blob_reserve(&b, 200)); 
+	TEST(b.buf == mem); 
+	blob_free(&b); 
+	blob_free(&a); 
+
+	// adopted malloc memory is never handed to the pool
+	void *raw = malloc(300); 
+	blob_init(&b, 0, 0); 
+	memcpy(raw, b.buf, sizeof(struct blob_field)); 
+	blob_free(&b); 
+	blob_pool_get_stats(&st); 
+	size_t retained = st.retained_bytes; 
+	TEST(blob_adopt(&b, raw, 300)); 
+	TEST(b.alloc == &blob_default_allocator); 
+	for(int c = 0; c < 100; c++) blob_put_int(&b, c); 
+	blob_free(&b); 
+	blob_pool_get_stats(&st); 
+	TEST(st.retained_bytes == retained); 
+
+	// buffers detached from a pooled blob go back through the pool
+	build(&a, 10); 
+	size_t len = 0, cap = 0; 
+	mem = blob_detach(&a, &len, &cap); 
+	TEST(cap >= len); 
+	blob_pool_get_stats(&st); 
+	TEST(st.retained_bytes < retained); 
+	TEST(blob_adopt_alloc(&b, &blob_pool_allocator, mem, cap)); 
+	TEST(blob_field_get_int(blob_field_first_child(blob_head(&b))) == 0); 
+	blob_free(&b); 
+	blob_free(&a); 
+	blob_pool_get_stats(&st); 
+	TEST(st.retained_bytes == retained); 
+
+	// buffers cached by exiting threads go to the global list
+	pthread_t t; 
+	pthread_create(&t, NULL, worker, NULL); 
+	pthread_join(t, NULL); 
+	blob_pool_get_stats(&st); 
+	TEST(st.hits > 100); 
+
+	blob_pool_disable(); 
+	blob_pool_get_stats(&st); 
+	TEST(st.retained_bytes == 0); 
+
+	// blobs created after disabling use the c library again
+	blob_init(&a, 0, 0); 
+	TEST(a.alloc == &blob_default_allocator); 
+	blob_free(&a); 
+
+	// other threads drop their caches the next time they use the pool
+	blob_pool_enable(NULL); 
+	pthread_barrier_init(&disabled, NULL, 2); 
+	pthread_create(&t, NULL, late_worker, NULL); 
+	pthread_barrier_wait(&disabled); 
+	blob_pool_get_stats(&st); 
+	TEST(st.retained_bytes > 0); 
+	blob_pool_disable(); 
+	pthread_barrier_wait(&disabled); 
+	pthread_join(t, NULL); 
+	TEST(retained_after_disable == 0); 
+	pthread_barrier_destroy(&disabled); 
+
+	return 0; 
+}
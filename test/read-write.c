@@ -10,6 +10,9 @@ int main(void){
 	char data_in[] = {1, 2, 3, 4, 5, 6, 7}; 
 	char data_out[sizeof(data_in)]; 
 
+	// type values of the original format never change (newer types come after the wildcard)
+	TEST(BLOB_FIELD_TABLE == 10 && BLOB_FIELD_ANY == 11); 
+
 	blob_put_bool(&blob, true); 
 	blob_put_string(&blob, "foo"); 
 	blob_put_int(&blob, -13); 
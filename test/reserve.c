@@ -0,0 +1,82 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+
+int main(void){
+	struct blob a, b; 
+	blob_init(&a, 0, 0); 
+	blob_init(&b, 0, 0); 
+
+	// strings formatted in place give the same blob as blob_put_string
+	for(int c = 0; c < 20; c++){
+		char tmp[64]; 
+		snprintf(tmp, sizeof(tmp), "log line %d", c * 1000); 
+		blob_put_string(&a, tmp); 
+
+		char *str = blob_put_string_reserve(&b, 63); 
+		TEST(str != NULL); 
+		int len = snprintf(str, 64, "log line %d", c * 1000); 
+		TEST(blob_put_string_commit(&b, (size_t)len) != NULL); 
+	}
+	blob_put_int(&a, 7); 
+	blob_put_int(&b, 7); 
+	TEST(blob_size(&a) == blob_size(&b)); 
+	TEST(memcmp(a.buf, b.buf, blob_size(&a)) == 0); 
+	TEST(blob_field_check(blob_head(&b), blob_size(&b))); 
+
+	// length taking put does not need a terminated string
+	blob_reset(&a); 
+	blob_reset(&b); 
+	blob_put_string(&a, "hello"); 
+	TEST(blob_put_stringn(&b, "hello world", 5) != NULL); 
+	TEST(blob_put_stringn(&b, NULL, 0) != NULL); 
+	blob_put_string(&a, ""); 
+	TEST(memcmp(a.buf, b.buf, blob_size(&a)) == 0); 
+
+	// binary reservations keep the exact committed length
+	blob_reset(&b); 
+	uint8_t *data = blob_put_binary_reserve(&b, 100); 
+	TEST(data != NULL); 
+	for(int c = 0; c < 5; c++) data[c] = (uint8_t)c; 
+	TEST(blob_put_binary_commit(&b, 5) != NULL); 
+	size_t len = 0; 
+	const uint8_t *out = blob_field_get_binary(blob_field_first_child(blob_head(&b)), &len); 
+	TEST(len == 5 && out[4] == 4); 
+	TEST(blob_size(&b) == 4 + 12); 
+
+	// commit without a reservation, of the wrong kind or longer than reserved fails
+	TEST(blob_put_string_commit(&b, 0) == NULL); 
+	TEST(blob_put_string_reserve(&b, 8) != NULL); 
+	TEST(blob_put_binary_commit(&b, 2) == NULL); 
+	TEST(blob_put_string_reserve(&b, 8) != NULL); 
+	TEST(blob_put_string_commit(&b, 9) == NULL); 
+	// as does a commit after something else was written
+	TEST(blob_put_string_reserve(&b, 8) != NULL); 
+	blob_put_int(&b, 1); 
+	TEST(blob_put_string_commit(&b, 2) == NULL); 
+
+	// a reservation larger than a short header can hold
+	blob_reset(&b); 
+	blob_set_max_size(&b, 64 * 1024 * 1024); 
+	char *big = blob_put_string_reserve(&b, BLOB_FIELD_LEN_MASK + 16); 
+	TEST(big != NULL); 
+	TEST(blob_field_is_extended(blob_head(&b))); 
+	strcpy(big, "shrunk"); 
+	struct blob_field *f = blob_put_string_commit(&b, 6); 
+	TEST(f != NULL); 
+	TEST(!blob_field_is_extended(f)); 
+	TEST(strcmp(blob_field_get_string(blob_field_first_child(blob_head(&b))), "shrunk") == 0); 
+	TEST(blob_field_check(blob_head(&b), blob_size(&b))); 
+
+	// nothing to reserve when only measuring
+	struct blob m; 
+	blob_init_measure(&m); 
+	TEST(blob_put_string_reserve(&m, 10) == NULL); 
+	TEST(blob_put_stringn(&m, "abc", 3) != NULL); 
+	blob_free(&m); 
+
+	blob_free(&a); 
+	blob_free(&b); 
+	return 0; 
+}
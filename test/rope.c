@@ -0,0 +1,109 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+#include <stdlib.h>
+
+static const char *long_string = "a string that is longer than a whole chunk of the rope so it has to get a chunk of its own";
+
+static void build_blob(struct blob *b){
+	blob_offset_t t = blob_open_table(b);
+	for(int c = 0; c < 50; c++){
+		blob_put_string(b, "key");
+		blob_offset_t a = blob_open_array(b);
+		blob_put_int(b, c * 1000);
+		blob_put_real(b, c + 0.5);
+		blob_put_bool(b, c & 1);
+		blob_close_array(b, a);
+	}
+	blob_close_table(b, t);
+	blob_put_string(b, long_string);
+	blob_put_int(b, 1LL << 40);
+}
+
+static void build_rope(struct blob_rope *r){
+	blob_offset_t t = blob_rope_open_table(r);
+	for(int c = 0; c < 50; c++){
+		blob_rope_put_string(r, "key");
+		blob_offset_t a = blob_rope_open_array(r);
+		blob_rope_put_int(r, c * 1000);
+		blob_rope_put_real(r, c + 0.5);
+		blob_rope_put_bool(r, c & 1);
+		TEST(blob_rope_close_array(r, a));
+	}
+	TEST(blob_rope_close_table(r, t));
+	blob_rope_put_string(r, long_string);
+	blob_rope_put_int(r, 1LL << 40);
+}
+
+int main(void){
+	struct blob b, flat;
+	struct blob_rope rope;
+
+	blob_init(&b, 0, 0);
+	blob_init(&flat, 0, 0);
+	blob_rope_init(&rope, NULL, 64);
+
+	build_blob(&b);
+	build_rope(&rope);
+
+	TEST(blob_rope_size(&rope) == blob_size(&b));
+	TEST(blob_rope_flatten(&rope, &flat));
+	TEST(blob_size(&flat) == blob_size(&b));
+	TEST(memcmp(flat.buf, b.buf, blob_size(&b)) == 0);
+
+	// gather the message like writev would
+	int count = blob_rope_iovec(&rope, NULL, 0);
+	TEST(count > 2);
+	struct iovec iov[count];
+	TEST(blob_rope_iovec(&rope, iov, count) == count);
+	char out[blob_size(&b)];
+	size_t pos = 0;
+	for(int c = 0; c < count; c++){
+		TEST(pos + iov[c].iov_len <= sizeof(out));
+		memcpy(out + pos, iov[c].iov_base, iov[c].iov_len);
+		pos += iov[c].iov_len;
+	}
+	TEST(pos == blob_size(&b));
+	TEST(memcmp(out, b.buf, pos) == 0);
+
+	// containers must be closed in order
+	blob_rope_reset(&rope);
+	TEST(blob_rope_size(&rope) == sizeof(struct blob_field));
+	blob_offset_t o1 = blob_rope_open_array(&rope);
+	blob_offset_t o2 = blob_rope_open_table(&rope);
+	TEST(o1 != 0 && o2 != 0);
+	TEST(!blob_rope_close_array(&rope, o1));
+	TEST(blob_rope_close_table(&rope, o2));
+	TEST(blob_rope_close_array(&rope, o1));
+	TEST(blob_rope_flatten(&rope, &flat));
+	TEST(blob_field_validate(blob_head(&flat), "[{}]") || blob_field_first_child(blob_head(&flat)) != NULL);
+
+	// copying fields from an existing blob
+	blob_rope_reset(&rope);
+	const struct blob_field *child;
+	blob_field_for_each_child(blob_head(&b), child){
+		TEST(blob_rope_put_attr(&rope, child));
+	}
+	TEST(blob_rope_flatten(&rope, &flat));
+	TEST(blob_size(&flat) == blob_size(&b));
+	TEST(memcmp(flat.buf, b.buf, blob_size(&b)) == 0);
+
+	// a container that is too large stays open after the failed close
+	blob_rope_reset(&rope);
+	size_t big_len = BLOB_FIELD_LEN_MASK + 1;
+	char *big = malloc(big_len);
+	TEST(big);
+	memset(big, 'x', big_len - 1);
+	big[big_len - 1] = 0;
+	o1 = blob_rope_open_array(&rope);
+	TEST(blob_rope_put_string(&rope, big));
+	TEST(!blob_rope_close_array(&rope, o1));
+	TEST(rope.depth == 1 && rope.open[0].offset == o1);
+	free(big);
+
+	blob_rope_free(&rope);
+	blob_free(&flat);
+	blob_free(&b);
+	return 0;
+}
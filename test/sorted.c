@@ -0,0 +1,157 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+
+static const char *names[] = { "port", "address", "zone", "mtu", "name", "id", "gateway", "broadcast" }; 
+#define NAMES (int)(sizeof(names) / sizeof(names[0]))
+
+static bool put_table(struct blob *b, int first, bool sort){
+	blob_offset_t t = blob_open_table(b); 
+	for(int c = 0; c < NAMES; c++){
+		int n = (first + c) % NAMES; 
+		blob_put_key(b, names[n]); 
+		if(n & 1) blob_put_string(b, names[n]); 
+		else blob_put_int(b, n * 100); 
+	}
+	if(sort) return blob_close_table_sorted(b, t); 
+	blob_close_table(b, t); 
+	return true; 
+}
+
+static bool check_table(const struct blob_field *tbl){
+	bool ok = true; 
+	for(int n = 0; n < NAMES; n++){
+		const struct blob_field *v = blob_table_find(tbl, names[n]); 
+		if(n & 1) ok = ok && v && strcmp(blob_field_get_string(v), names[n]) == 0; 
+		else ok = ok && v && blob_field_get_int(v) == n * 100; 
+	}
+	return ok; 
+}
+
+int main(void){
+	struct blob a, b; 
+	blob_init(&a, 0, 0); 
+	blob_init(&b, 0, 0); 
+
+	TEST(put_table(&a, 0, true)); 
+	const struct blob_field *tbl = blob_field_first_child(blob_head(&a)); 
+	TEST(blob_field_type(tbl) == BLOB_FIELD_TABLE); 
+	TEST(blob_field_is_sorted(tbl)); 
+	TEST(blob_field_check(blob_head(&a), blob_size(&a))); 
+	const struct blob_field *key, *value; 
+	const char *prev = ""; 
+	blob_field_for_each_kv(tbl, key, value){
+		TEST(strcmp(prev, blob_field_get_string(key)) < 0); 
+		prev = blob_field_get_string(key); 
+	}
+	TEST(check_table(tbl)); 
+	TEST(blob_table_find(tbl, "aaa") == NULL); 
+	TEST(blob_table_find(tbl, "nothing") == NULL); 
+	TEST(blob_table_find(tbl, "zzz") == NULL); 
+
+	// the sorted layout does not depend on the order the pairs were written in
+	TEST(put_table(&b, 3, true)); 
+	TEST(blob_size(&a) == blob_size(&b)); 
+	TEST(memcmp(a.buf, b.buf, blob_size(&a)) == 0); 
+
+	// unsorted tables are searched all the way
+	blob_reset(&b); 
+	TEST(put_table(&b, 5, false)); 
+	TEST(!blob_field_is_sorted(blob_field_first_child(blob_head(&b)))); 
+	TEST(check_table(blob_field_first_child(blob_head(&b)))); 
+
+	// repeated keys stay in the order they were written and the last one wins
+	blob_reset(&b); 
+	blob_offset_t dup = blob_open_table(&b); 
+	blob_put_string(&b, "b"); 
+	blob_put_int(&b, 1); 
+	blob_put_string(&b, "a"); 
+	blob_put_int(&b, 2); 
+	blob_put_string(&b, "b"); 
+	blob_put_int(&b, 3); 
+	blob_put_string(&b, "c"); 
+	blob_put_int(&b, 4); 
+	blob_close_table(&b, dup); 
+	TEST(blob_field_get_int(blob_table_find(blob_field_first_child(blob_head(&b)), "b")) == 3); 
+	blob_reset(&b); 
+	dup = blob_open_table(&b); 
+	blob_put_string(&b, "b"); 
+	blob_put_int(&b, 1); 
+	blob_put_string(&b, "c"); 
+	blob_put_int(&b, 4); 
+	blob_put_string(&b, "b"); 
+	blob_put_int(&b, 3); 
+	TEST(blob_close_table_sorted(&b, dup)); 
+	TEST(blob_field_get_int(blob_table_find(blob_field_first_child(blob_head(&b)), "b")) == 3); 
+	TEST(blob_table_find(blob_field_first_child(blob_head(&b)), "bb") == NULL); 
+
+	// a flag on anything but a table is rejected
+	blob_reset(&b); 
+	blob_put_string(&b, "not a table"); 
+	struct blob_field *str = (struct blob_field*)(void*)((char*)b.buf + 4); 
+	str->id_len |= htobe32(BLOB_FIELD_SORTED); 
+	TEST(blob_field_type(str) == BLOB_FIELD_STRING); 
+	TEST(!blob_field_check(blob_head(&b), blob_size(&b))); 
+
+	// key references follow the strings they point to
+	blob_reset(&a); 
+	blob_reset(&b); 
+	TEST(blob_set_intern_keys(&a, true)); 
+	blob_offset_t arr = blob_open_array(&a); 
+	for(int c = 0; c < 4; c++) TEST(put_table(&a, c, true)); 
+	blob_close_array(&a, arr); 
+	TEST(blob_field_check(blob_head(&a), blob_size(&a))); 
+	int count = 0; 
+	const struct blob_field *rec; 
+	blob_field_for_each_child(blob_field_first_child(blob_head(&a)), rec){
+		TEST(blob_field_is_sorted(rec)); 
+		TEST(check_table(rec)); 
+		count++; 
+	}
+	TEST(count == 4); 
+	rec = blob_field_first_child(blob_field_first_child(blob_head(&a))); 
+	TEST(blob_field_type(blob_field_first_child(blob_field_next_child(blob_field_first_child(blob_head(&a)), rec))) == BLOB_FIELD_KEYREF); 
+
+	// a reference that would have to point forwards leaves the table unsorted
+	TEST(blob_set_intern_keys(&b, true)); 
+	blob_offset_t t = blob_open_table(&b); 
+	blob_put_key(&b, "b"); 
+	blob_offset_t inner = blob_open_table(&b); 
+	blob_put_key(&b, "id"); 
+	blob_put_int(&b, 1); 
+	blob_close_table(&b, inner); 
+	blob_put_key(&b, "a"); 
+	inner = blob_open_table(&b); 
+	blob_put_key(&b, "id"); 
+	blob_put_int(&b, 2); 
+	blob_close_table(&b, inner); 
+	TEST(!blob_close_table_sorted(&b, t)); 
+	tbl = blob_field_first_child(blob_head(&b)); 
+	TEST(!blob_field_is_sorted(tbl)); 
+	TEST(blob_field_check(blob_head(&b), blob_size(&b))); 
+	TEST(blob_field_get_int(blob_table_find(blob_table_find(tbl, "a"), "id")) == 2); 
+
+	// as do keys that are not strings
+	blob_reset(&b); 
+	t = blob_open_table(&b); 
+	blob_put_string(&b, "b"); 
+	blob_put_int(&b, 1); 
+	blob_put_int(&b, 2); 
+	blob_put_int(&b, 3); 
+	TEST(!blob_close_table_sorted(&b, t)); 
+	TEST(!blob_field_is_sorted(blob_field_first_child(blob_head(&b)))); 
+
+	// measuring gives the same size
+	struct blob m; 
+	blob_init_measure(&m); 
+	TEST(put_table(&m, 2, true)); 
+	blob_reset(&b); 
+	TEST(put_table(&b, 2, true)); 
+	TEST(blob_measured_size(&m) == blob_size(&b)); 
+	blob_free(&m); 
+
+	blob_free(&a); 
+	blob_free(&b); 
+	return 0; 
+}
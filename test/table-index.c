@@ -0,0 +1,102 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+
+static int allocs = 0; 
+static void *counting_alloc(void *ctx, size_t size){ allocs++; return malloc(size); }
+static void *counting_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size){ return realloc(ptr, new_size); }
+static void counting_free(void *ctx, void *ptr, size_t size){ allocs--; free(ptr); }
+static const struct blob_allocator counting = { .alloc = counting_alloc, .realloc = counting_realloc, .free = counting_free }; 
+
+int main(void){
+	struct blob b; 
+	blob_init(&b, 0, 0); 
+	blob_offset_t t = blob_open_table(&b); 
+	for(int c = 0; c < 5000; c++){
+		char key[16]; 
+		snprintf(key, sizeof(key), "key%d", c); 
+		blob_put_string(&b, key); 
+		blob_put_int(&b, c); 
+	}
+	blob_put_string(&b, "key7"); // duplicate keys resolve to the last value
+	blob_put_string(&b, "again"); 
+	blob_close_table(&b, t); 
+	const struct blob_field *tbl = blob_field_first_child(blob_head(&b)); 
+
+	struct blob_table_index idx; 
+	TEST(blob_table_index_build_alloc(tbl, &idx, &counting)); 
+	TEST(allocs == 1); 
+	TEST(idx.count == 5000); 
+	bool found = true; 
+	for(int c = 0; c < 5000; c++){
+		char key[16]; 
+		snprintf(key, sizeof(key), "key%d", c); 
+		const struct blob_field *v = blob_table_index_get(&idx, key); 
+		if(c == 7) found = found && v && strcmp(blob_field_get_string(v), "again") == 0; 
+		else found = found && v && blob_field_get_int(v) == c; 
+	}
+	TEST(found); 
+	// scanning and paths agree with the index
+	TEST(blob_table_find(tbl, "key7") == blob_table_index_get(&idx, "key7")); 
+	struct blob_path *path = blob_path_compile("key7"); 
+	TEST(blob_path_get(tbl, path) == blob_table_index_get(&idx, "key7")); 
+	blob_path_free(path); 
+	TEST(blob_table_index_get(&idx, "key5000") == NULL); 
+	TEST(blob_table_index_get(&idx, "key") == NULL); 
+	TEST(blob_table_index_get(&idx, "") == NULL); 
+	TEST(blob_field_get_int(blob_table_index_getn(&idx, "key42 and more", 5)) == 42); 
+	TEST(blob_table_index_getn(&idx, "key4\0", 5) == NULL); 
+	blob_table_index_free(&idx); 
+	TEST(allocs == 0); 
+	TEST(blob_table_index_get(&idx, "key1") == NULL); 
+
+	// caller provided memory
+	size_t size = blob_table_index_mem_size(tbl); 
+	TEST(size >= 5000 * 2 * sizeof(struct blob_table_slot)); 
+	void *mem = malloc(size); 
+	TEST(!blob_table_index_build_mem(tbl, &idx, mem, size - 1)); 
+	TEST(blob_table_index_build_mem(tbl, &idx, mem, size)); 
+	TEST(blob_field_get_int(blob_table_index_get(&idx, "key4999")) == 4999); 
+	blob_table_index_free(&idx); 
+	free(mem); 
+
+	// only tables can be indexed
+	TEST(blob_table_index_mem_size(blob_head(&b)) == 0); 
+	TEST(!blob_table_index_build(blob_head(&b), &idx)); 
+	TEST(!blob_table_index_build(NULL, &idx)); 
+
+	// interned keys are followed to their string
+	struct blob k; 
+	blob_init(&k, 0, 0); 
+	blob_set_intern_keys(&k, true); 
+	blob_offset_t a = blob_open_array(&k); 
+	for(int c = 0; c < 2; c++){
+		t = blob_open_table(&k); 
+		blob_put_key(&k, "name"); 
+		blob_put_string(&k, c ? "second" : "first"); 
+		blob_put_key(&k, "id"); 
+		blob_put_int(&k, c); 
+		blob_close_table(&k, t); 
+	}
+	blob_close_array(&k, a); 
+	const struct blob_field *second = blob_field_next_child(blob_field_first_child(blob_head(&k)), blob_field_first_child(blob_field_first_child(blob_head(&k)))); 
+	TEST(blob_field_type(blob_field_first_child(second)) == BLOB_FIELD_KEYREF); 
+	TEST(blob_table_index_build(second, &idx)); 
+	TEST(strcmp(blob_field_get_string(blob_table_index_get(&idx, "name")), "second") == 0); 
+	TEST(blob_field_get_int(blob_table_index_get(&idx, "id")) == 1); 
+	blob_table_index_free(&idx); 
+
+	// empty table
+	blob_reset(&k); 
+	t = blob_open_table(&k); 
+	blob_close_table(&k, t); 
+	TEST(blob_table_index_build(blob_field_first_child(blob_head(&k)), &idx)); 
+	TEST(idx.count == 0); 
+	TEST(blob_table_index_get(&idx, "x") == NULL); 
+	blob_table_index_free(&idx); 
+
+	blob_free(&k); 
+	blob_free(&b); 
+	return 0; 
+}
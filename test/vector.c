@@ -0,0 +1,198 @@
+#include "test-funcs.h"
+#include <blobpack.h>
+#include <stdbool.h>
+#include <memory.h>
+
+int main(void){
+	struct blob b; 
+	blob_init(&b, 0, 0); 
+
+	int8_t i8[] = { -128, -1, 0, 1, 127 }; 
+	int16_t i16[] = { -32768, 1000, 32767 }; 
+	int32_t i32[] = { INT32_MIN, 0, INT32_MAX }; 
+	int64_t i64[] = { INT64_MIN, 1LL << 40, INT64_MAX }; 
+	float f32[] = { -1.5f, 0.0f, 3.25f }; 
+	double f64[] = { 0.1, -1e300, 2.5 }; 
+
+	TEST(blob_put_vector(&b, BLOB_FIELD_INT8, i8, 5) != NULL); 
+	TEST(blob_put_vector(&b, BLOB_FIELD_INT16, i16, 3) != NULL); 
+	TEST(blob_put_vector(&b, BLOB_FIELD_INT32, i32, 3) != NULL); 
+	TEST(blob_put_vector(&b, BLOB_FIELD_INT64, i64, 3) != NULL); 
+	TEST(blob_put_vector(&b, BLOB_FIELD_FLOAT32, f32, 3) != NULL); 
+	TEST(blob_put_vector(&b, BLOB_FIELD_FLOAT64, f64, 3) != NULL); 
+	TEST(blob_put_vector(&b, BLOB_FIELD_STRING, i8, 5) == NULL); 
+	TEST(blob_field_check(blob_head(&b), blob_size(&b))); 
+
+	// 5 int8 values take 4 + 4 + 5 bytes (padded to 16) instead of 5 * 8 as an array
+	const struct blob_field *v = blob_field_first_child(blob_head(&b)); 
+	TEST(blob_field_type(v) == BLOB_FIELD_VECTOR); 
+	TEST(blob_field_raw_pad_len(v) == 16); 
+	TEST(blob_field_vector_type(v) == BLOB_FIELD_INT8); 
+	TEST(blob_field_vector_count(v) == 5); 
+	for(int c = 0; c < 5; c++) TEST(blob_field_vector_get_int(v, c) == i8[c]); 
+	TEST(blob_field_vector_get_int(v, 5) == 0); 
+
+	v = blob_field_next_child(blob_head(&b), v); 
+	int16_t o16[3]; 
+	TEST(blob_field_vector_copy(v, o16, 3) == 3); 
+	TEST(memcmp(o16, i16, sizeof(i16)) == 0); 
+
+	v = blob_field_next_child(blob_head(&b), v); 
+	int32_t o32[8]; 
+	TEST(blob_field_vector_copy(v, o32, 8) == 3); 
+	TEST(memcmp(o32, i32, sizeof(i32)) == 0); 
+
+	v = blob_field_next_child(blob_head(&b), v); 
+	for(int c = 0; c < 3; c++) TEST(blob_field_vector_get_int(v, c) == i64[c]); 
+
+	v = blob_field_next_child(blob_head(&b), v); 
+	TEST(blob_field_vector_type(v) == BLOB_FIELD_FLOAT32); 
+	for(int c = 0; c < 3; c++) TEST(blob_field_vector_get_real(v, c) == f32[c]); 
+	TEST(blob_field_vector_get_int(v, 2) == 3); 
+
+	v = blob_field_next_child(blob_head(&b), v); 
+	double o64[3]; 
+	TEST(blob_field_vector_copy(v, o64, 3) == 3); 
+	TEST(memcmp(o64, f64, sizeof(f64)) == 0); 
+
+	// elements are stored in network byte order
+	blob_reset(&b); 
+	uint32_t one = 0x01020304; 
+	v = blob_put_vector(&b, BLOB_FIELD_INT32, &one, 1); 
+	const uint8_t *raw = (const uint8_t*)blob_field_data(v) + BLOB_VECTOR_HDR_LEN; 
+	TEST(raw[0] == 1 && raw[3] == 4); 
+
+	// json export writes plain arrays
+	blob_reset(&b); 
+	blob_put_vector(&b, BLOB_FIELD_INT16, i16, 3); 
+	char *json = blob_to_json(&b); 
+	TEST(strcmp(json, "[[-32768,1000,32767]]") == 0); 
+	free(json); 
+
+	// import packs numeric arrays only when asked to
+	struct blob plain; 
+	blob_init(&plain, 0, 0); 
+	const char *doc = "{\"ints\":[1,2,300000],\"reals\":[0.5,1.25],\"mixed\":[1,0.5],\"strings\":[\"a\"],\"empty\":[],\"nested\":[[1,2],[3]]}"; 
+	TEST(blob_put_json(&plain, doc)); 
+	blob_reset(&b); 
+	TEST(blob_put_json_vectors(&b, doc)); 
+	TEST(blob_size(&b) < blob_size(&plain)); 
+	TEST(blob_field_check(blob_head(&b), blob_size(&b))); 
+
+	const struct blob_field *tbl = blob_field_first_child(blob_head(&b)); 
+	const struct blob_field *key, *value; 
+	blob_field_for_each_kv(tbl, key, value){
+		const char *k = blob_field_get_string(key); 
+		if(!strcmp(k, "ints")){
+			TEST(blob_field_type(value) == BLOB_FIELD_VECTOR); 
+			TEST(blob_field_vector_type(value) == BLOB_FIELD_INT32); 
+			TEST(blob_field_vector_get_int(value, 1) == 2); 
+			TEST(blob_field_vector_get_int(value, 2) == 300000); 
+		} else if(!strcmp(k, "reals")){
+			TEST(blob_field_type(value) == BLOB_FIELD_VECTOR); 
+			TEST(blob_field_vector_get_real(value, 1) == 1.25); 
+		} else if(!strcmp(k, "nested")){
+			TEST(blob_field_type(value) == BLOB_FIELD_ARRAY); 
+			TEST(blob_field_type(blob_field_first_child(value)) == BLOB_FIELD_VECTOR); 
+		} else {
+			TEST(blob_field_type(value) == BLOB_FIELD_ARRAY); 
+		}
+	}
+
+	// negative numbers are widened with their sign
+	blob_reset(&b); 
+	TEST(blob_put_json_vectors(&b, "[-1,-200,5]")); 
+	v = blob_field_first_child(blob_head(&b)); 
+	TEST(blob_field_vector_type(v) == BLOB_FIELD_INT16); 
+	TEST(blob_field_vector_get_int(v, 0) == -1); 
+	TEST(blob_field_vector_get_int(v, 1) == -200); 
+	json = blob_to_json(&b); 
+	TEST(strcmp(json, "[[-1,-200,5]]") == 0); 
+	free(json); 
+	blob_reset(&b); 
+	TEST(blob_put_json_vectors(&b, doc)); 
+
+	// and exports the same json as the unpacked blob
+	char *a = blob_to_json(&plain); 
+	char *c = blob_to_json(&b); 
+	TEST(strcmp(a, c) == 0); 
+	free(a); 
+	free(c); 
+
+	// narrow children in front of a wide one are widened without losing the ones behind them
+	blob_reset(&b); 
+	blob_offset_t o = blob_open_array(&b); 
+	blob_put_real(&b, 0.5); 
+	blob_put_real(&b, 0.1); 
+	blob_put_real(&b, 0.25); 
+	TEST(blob_close_array_vector(&b, o)); 
+	o = blob_open_array(&b); 
+	blob_put_int(&b, 1); 
+	blob_put_int(&b, 2); 
+	blob_put_int(&b, 1LL << 40); 
+	TEST(blob_close_array_vector(&b, o)); 
+	// more elements than fit into the scratch space on the stack
+	o = blob_open_array(&b); 
+	for(int i = 0; i < 100; i++) blob_put_int(&b, i); 
+	blob_put_int(&b, INT64_MAX); 
+	TEST(blob_close_array_vector(&b, o)); 
+	TEST(blob_field_check(blob_head(&b), blob_size(&b))); 
+	v = blob_field_first_child(blob_head(&b)); 
+	TEST(blob_field_vector_type(v) == BLOB_FIELD_FLOAT64); 
+	TEST(blob_field_vector_get_real(v, 0) == 0.5); 
+	TEST(blob_field_vector_get_real(v, 1) == 0.1); 
+	TEST(blob_field_vector_get_real(v, 2) == 0.25); 
+	v = blob_field_next_child(blob_head(&b), v); 
+	TEST(blob_field_vector_type(v) == BLOB_FIELD_INT64); 
+	TEST(blob_field_vector_get_int(v, 0) == 1); 
+	TEST(blob_field_vector_get_int(v, 1) == 2); 
+	TEST(blob_field_vector_get_int(v, 2) == 1LL << 40); 
+	v = blob_field_next_child(blob_head(&b), v); 
+	TEST(blob_field_vector_count(v) == 101); 
+	bool same = true; 
+	for(int i = 0; i < 100; i++) same = same && blob_field_vector_get_int(v, i) == i; 
+	TEST(same); 
+	TEST(blob_field_vector_get_int(v, 100) == INT64_MAX); 
+	blob_reset(&b); 
+	TEST(blob_put_json_vectors(&b, "[[0.5,0.1,0.3]]")); 
+	v = blob_field_first_child(blob_field_first_child(blob_head(&b))); 
+	TEST(blob_field_type(v) == BLOB_FIELD_VECTOR); 
+	TEST(blob_field_vector_get_real(v, 0) == 0.5); 
+	TEST(blob_field_vector_get_real(v, 1) == 0.1); 
+	TEST(blob_field_vector_get_real(v, 2) == 0.3); 
+
+	// blobs in fixed memory take larger scratch space from the default allocator
+	char mem[1024]; 
+	struct blob fixed; 
+	TEST(blob_init_fixed(&fixed, mem, sizeof(mem))); 
+	o = blob_open_array(&fixed); 
+	for(int i = 0; i < 40; i++) blob_put_real(&fixed, i + 0.1); 
+	TEST(blob_close_array_vector(&fixed, o)); 
+	v = blob_field_first_child(blob_head(&fixed)); 
+	TEST(blob_field_type(v) == BLOB_FIELD_VECTOR); 
+	TEST(blob_field_vector_type(v) == BLOB_FIELD_FLOAT64); 
+	TEST(blob_field_vector_get_real(v, 39) == 39 + 0.1); 
+	// arrays of other fields are closed but stay arrays
+	o = blob_open_array(&fixed); 
+	blob_put_string(&fixed, "x"); 
+	TEST(blob_close_array_vector(&fixed, o)); 
+	TEST(blob_field_type(blob_field_next_child(blob_head(&fixed), v)) == BLOB_FIELD_ARRAY); 
+	blob_free(&fixed); 
+
+	// vectors over 16MB get an extended header
+	blob_reset(&b); 
+	blob_set_max_size(&b, 64 * 1024 * 1024); 
+	size_t big_count = 5 * 1024 * 1024; 
+	int32_t *big = calloc(big_count, sizeof(int32_t)); 
+	big[big_count - 1] = 42; 
+	v = blob_put_vector(&b, BLOB_FIELD_INT32, big, big_count); 
+	TEST(v != NULL); 
+	TEST(blob_field_is_extended(v)); 
+	TEST(blob_field_vector_count(v) == big_count); 
+	TEST(blob_field_vector_get_int(v, big_count - 1) == 42); 
+	free(big); 
+
+	blob_free(&plain); 
+	blob_free(&b); 
+	return 0; 
+}